@@ -0,0 +1,166 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// Programa de shader compartilhado pelos exemplos.
+// Compila e linka o par vertex/fragment e, logo depois do link, percorre os uniforms ativos
+// guardando a localização de cada um em uma tabela. Os caminhos de desenho pegam a
+// localização uma vez na inicialização e não chamam mais glGetUniformLocation por nome.
+
+// Ponto de ligação do bloco de câmera, o mesmo para todos os programas
+const GLuint PONTO_BLOCO_CAMERA = 0;
+
+// Declaração do bloco que os shaders devem usar para receber view e projeção:
+//   layout (std140) uniform Camera { mat4 view; mat4 proj; };
+struct DadosCamera
+{
+    glm::mat4 view;
+    glm::mat4 proj;
+};
+
+class ProgramaShader
+{
+public:
+    GLuint id = 0;
+
+    ProgramaShader() {}
+    ProgramaShader(const GLchar *vertexSource, const GLchar *fragmentSource)
+    {
+        compilar(vertexSource, fragmentSource);
+    }
+
+    // Compila, linka e reflete os uniforms; devolve false se algum passo falhar
+    bool compilar(const GLchar *vertexSource, const GLchar *fragmentSource)
+    {
+        GLuint vertexShader = compilarEtapa(GL_VERTEX_SHADER, vertexSource, "VERTEX");
+        GLuint fragmentShader = compilarEtapa(GL_FRAGMENT_SHADER, fragmentSource, "FRAGMENT");
+
+        id = glCreateProgram();
+        glAttachShader(id, vertexShader);
+        glAttachShader(id, fragmentShader);
+        glLinkProgram(id);
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+
+        GLint success;
+        glGetProgramiv(id, GL_LINK_STATUS, &success);
+        if (!success)
+        {
+            GLchar infoLog[512];
+            glGetProgramInfoLog(id, 512, nullptr, infoLog);
+            std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
+                      << infoLog << std::endl;
+            return false;
+        }
+
+        refletirUniforms();
+
+        // o bloco de câmera, se o programa usar, fica ligado ao ponto comum
+        GLuint bloco = glGetUniformBlockIndex(id, "Camera");
+        if (bloco != GL_INVALID_INDEX)
+            glUniformBlockBinding(id, bloco, PONTO_BLOCO_CAMERA);
+        return true;
+    }
+
+    void usar() const
+    {
+        glUseProgram(id);
+    }
+
+    // Localização de um uniform ativo; -1 (ignorado pelo glUniform*) se ele não existir.
+    // Feita para a inicialização: guarde o resultado em vez de chamar a cada desenho.
+    GLint uniform(const std::string &nome) const
+    {
+        auto it = locais.find(nome);
+        return it == locais.end() ? -1 : it->second;
+    }
+
+private:
+    std::unordered_map<std::string, GLint> locais;
+
+    static GLuint compilarEtapa(GLenum tipo, const GLchar *source, const char *nomeEtapa)
+    {
+        GLuint shader = glCreateShader(tipo);
+        glShaderSource(shader, 1, &source, nullptr);
+        glCompileShader(shader);
+
+        GLint success;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success)
+        {
+            GLchar infoLog[512];
+            glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+            std::cout << "ERROR::SHADER::" << nomeEtapa << "::COMPILATION_FAILED\n"
+                      << infoLog << std::endl;
+        }
+        return shader;
+    }
+
+    void refletirUniforms()
+    {
+        locais.clear();
+
+        GLint nUniforms = 0, maiorNome = 0;
+        glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &nUniforms);
+        glGetProgramiv(id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maiorNome);
+
+        std::string nome(maiorNome > 0 ? maiorNome : 1, '\0');
+        for (GLint i = 0; i < nUniforms; i++)
+        {
+            GLsizei comprimento = 0;
+            GLint tamanho;
+            GLenum tipo;
+            glGetActiveUniform(id, (GLuint)i, maiorNome, &comprimento, &tamanho, &tipo, &nome[0]);
+            std::string chave(nome.c_str(), comprimento);
+
+            // uniforms de blocos não têm localização própria
+            GLint loc = glGetUniformLocation(id, chave.c_str());
+            if (loc < 0)
+                continue;
+
+            // vetores aparecem como "nome[0]"; guarda também pelo nome puro
+            locais[chave] = loc;
+            size_t colchete = chave.find('[');
+            if (colchete != std::string::npos)
+                locais[chave.substr(0, colchete)] = loc;
+        }
+    }
+};
+
+// Uniform buffer std140 com view e projeção, enviado uma vez por frame e lido por todos
+// os programas que declaram o bloco Camera
+class BlocoCamera
+{
+public:
+    GLuint ubo = 0;
+
+    void criar()
+    {
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(DadosCamera), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, PONTO_BLOCO_CAMERA, ubo);
+    }
+
+    // mat4 em std140 são quatro vec4 seguidos, exatamente o layout de glm::mat4
+    void enviar(const glm::mat4 &view, const glm::mat4 &proj)
+    {
+        DadosCamera dados = {view, proj};
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(DadosCamera), &dados);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    void destruir()
+    {
+        glDeleteBuffers(1, &ubo);
+        ubo = 0;
+    }
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <glm/glm.hpp>
+
+// Atlas de texturas dos sprites: junta várias imagens RGBA em uma só, para que todos os
+// sprites sejam desenhados com uma única textura ligada. As imagens são arrumadas em
+// prateleiras (as mais altas primeiro), com uma borda transparente de 1 texel entre elas para
+// que a amostragem na beira de um quadro não pegue pixels da imagem vizinha.
+// Aqui não há OpenGL: o resultado é o vetor de pixels e o retângulo UV de cada imagem.
+
+const int BORDA_ATLAS = 1;
+
+struct RegiaoAtlas
+{
+    int x, y, largura, altura; // em texels, com a linha 0 embaixo (como a imagem carregada invertida)
+    glm::vec4 uv;              // canto (u, v) e tamanho (du, dv) em coordenadas de textura
+};
+
+class AtlasSprites
+{
+public:
+    // Guarda uma cópia da imagem (largura × altura × 4 bytes) e devolve o índice da região
+    int adicionar(const unsigned char *rgba, int largura, int altura)
+    {
+        imagens.push_back(std::vector<unsigned char>(rgba, rgba + (size_t)largura * altura * 4));
+        regioes.push_back({0, 0, largura, altura, glm::vec4(0.0f)});
+        return (int)regioes.size() - 1;
+    }
+
+    // Arruma as imagens e monta os pixels; devolve false se não couberem em larguraMaxima
+    bool montar(int larguraMaxima = 4096)
+    {
+        std::vector<int> ordem(regioes.size());
+        long long area = 0;
+        int maisLarga = 0;
+        for (size_t i = 0; i < regioes.size(); i++)
+        {
+            ordem[i] = (int)i;
+            area += (long long)(regioes[i].largura + BORDA_ATLAS) * (regioes[i].altura + BORDA_ATLAS);
+            maisLarga = std::max(maisLarga, regioes[i].largura + 2 * BORDA_ATLAS);
+        }
+        if (maisLarga > larguraMaxima)
+            return false;
+        std::sort(ordem.begin(), ordem.end(), [this](int a, int b) { return regioes[a].altura > regioes[b].altura; });
+
+        // largura perto da raiz da área, para o atlas sair mais ou menos quadrado
+        largura = std::min(larguraMaxima, std::max(maisLarga, (int)std::ceil(std::sqrt((double)area))));
+
+        int x = BORDA_ATLAS, y = BORDA_ATLAS, alturaPrateleira = 0;
+        for (int i : ordem)
+        {
+            RegiaoAtlas &r = regioes[i];
+            if (x + r.largura + BORDA_ATLAS > largura)
+            {
+                x = BORDA_ATLAS;
+                y += alturaPrateleira + BORDA_ATLAS;
+                alturaPrateleira = 0;
+            }
+            r.x = x;
+            r.y = y;
+            x += r.largura + BORDA_ATLAS;
+            alturaPrateleira = std::max(alturaPrateleira, r.altura);
+        }
+        altura = y + alturaPrateleira + BORDA_ATLAS;
+
+        pixels.assign((size_t)largura * altura * 4, 0);
+        for (size_t i = 0; i < regioes.size(); i++)
+        {
+            RegiaoAtlas &r = regioes[i];
+            for (int linha = 0; linha < r.altura; linha++)
+                std::memcpy(&pixels[((size_t)(r.y + linha) * largura + r.x) * 4],
+                            &imagens[i][(size_t)linha * r.largura * 4], (size_t)r.largura * 4);
+            r.uv = glm::vec4((float)r.x / largura, (float)r.y / altura, (float)r.largura / largura, (float)r.altura / altura);
+        }
+        imagens.clear();
+        return true;
+    }
+
+    // Retângulo UV do quadro (coluna, linha) de uma folha de sprites nColunas × nLinhas
+    glm::vec4 uvQuadro(int regiao, int coluna, int linha, int nColunas, int nLinhas) const
+    {
+        const glm::vec4 &uv = regioes[regiao].uv;
+        glm::vec2 tamanho(uv.z / nColunas, uv.w / nLinhas);
+        return glm::vec4(uv.x + coluna * tamanho.x, uv.y + linha * tamanho.y, tamanho.x, tamanho.y);
+    }
+
+    std::vector<RegiaoAtlas> regioes;
+    std::vector<unsigned char> pixels;
+    int largura = 0, altura = 0;
+
+private:
+    std::vector<std::vector<unsigned char>> imagens; // cópias até montar
+};
@@ -0,0 +1,104 @@
+// Benchmark da broadphase de colisões (HashEspacial.h): retângulos do tamanho dos sprites do
+// runner espalhados num mundo que cresce com a quantidade, para a densidade ficar constante.
+// Compara todos contra todos (força bruta) com o hash espacial refeito a cada tick, confere que
+// os dois acham os mesmos pares e mede o tempo por tick e os pares resolvidos por segundo (os
+// n(n-1)/2 pares possíveis dividido pelo tempo), junto com quantos passaram pelo teste exato.
+
+#include <iostream>
+#include <cstdio>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <glm/glm.hpp>
+
+#include "HashEspacial.h"
+
+using namespace std;
+
+double agoraMs()
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+typedef vector<pair<uint32_t, uint32_t>> ListaPares;
+
+// Todos contra todos; devolve os pares que se intersectam, em ordem
+size_t forcaBruta(const vector<Rect> &rects, ListaPares &pares)
+{
+    pares.clear();
+    size_t n = rects.size();
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = i + 1; j < n; j++)
+            if (rects[i].intersects(rects[j]))
+                pares.push_back({(uint32_t)i, (uint32_t)j});
+    return n * (n - 1) / 2;
+}
+
+size_t comHash(HashEspacial &hash, const vector<Rect> &rects, ListaPares &pares)
+{
+    pares.clear();
+    hash.construir(rects.data(), rects.size());
+    return hash.paraCadaPar([&](uint32_t i, uint32_t j) { pares.push_back({i, j}); });
+}
+
+int main()
+{
+    const size_t quantidades[] = {1000, 10000, 100000};
+    const double msPorMedida = 1000.0; // repete cada caminho até passar de cerca de 1 s
+
+    printf("%9s | %-11s | %10s | %10s | %12s | %12s | %9s\n", "entidades", "caminho", "ms/tick", "colisões", "testados",
+           "Mpares/s", "aceleração");
+    printf("----------+-------------+------------+------------+--------------+--------------+-----------\n");
+
+    for (size_t n : quantidades)
+    {
+        // lados entre 0,05 e 0,2, como os sprites do jogo; mundo com cerca de 50% da área coberta
+        mt19937 rng(7);
+        uniform_real_distribution<float> lado(0.05f, 0.2f);
+        float mundo = sqrt((float)n * 0.0156f / 0.5f);
+        uniform_real_distribution<float> coord(-mundo / 2.0f, mundo / 2.0f);
+        vector<Rect> rects(n);
+        for (Rect &r : rects)
+            r = {glm::vec2(coord(rng), coord(rng)), glm::vec2(lado(rng), lado(rng))};
+
+        HashEspacial hash(0.2f);
+        hash.reservar(n);
+        ListaPares referencia, pares;
+
+        double msBruta = 0.0;
+        for (int caminho = 0; caminho < 2; caminho++)
+        {
+            size_t testes = caminho == 0 ? forcaBruta(rects, referencia) : comHash(hash, rects, pares);
+            bool igual = true;
+            if (caminho == 1)
+            {
+                sort(pares.begin(), pares.end());
+                igual = pares == referencia;
+            }
+
+            int repeticoes = 0;
+            double t0 = agoraMs(), ms = 0.0;
+            do
+            {
+                if (caminho == 0)
+                    forcaBruta(rects, pares);
+                else
+                    comHash(hash, rects, pares);
+                repeticoes++;
+                ms = agoraMs() - t0;
+            } while (ms < msPorMedida);
+            ms /= repeticoes;
+            if (caminho == 0)
+                msBruta = ms;
+
+            char aceleracao[32];
+            snprintf(aceleracao, sizeof(aceleracao), "%.1fx", msBruta / ms);
+            printf("%9zu | %-11s | %10.3f | %10zu | %12zu | %12.1f | %9s%s\n", n, caminho == 0 ? "força bruta" : "hash",
+                   ms, referencia.size(), testes, (double)n * (n - 1) / 2.0 / ms / 1000.0, aceleracao,
+                   igual ? "" : "  (DIFERENTE da força bruta!)");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,151 @@
+// Benchmark da disposição das entidades: 100.000 sprites guardados como estruturas inteiras
+// (o Sprite antigo do Game.cpp, com os campos de desenho misturados aos do laço) e no
+// RegistroSprites, com um vetor por componente. Mede separadamente os laços de movimento,
+// animação e retângulos de colisão e o tick completo, em milhões de entidades por segundo, e
+// confere que as duas disposições chegam ao mesmo estado.
+
+#include <iostream>
+#include <cstdio>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "RegistroSprites.h"
+
+using namespace std;
+
+double agoraMs()
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// O Sprite como era antes do atlas e do registro, mais a velocidade
+struct SpriteAntigo
+{
+    uint32_t VAO, texID;
+    glm::vec2 pos, prevPos, vel, size;
+    float angle;
+    int nFrames, nAnimations, iFrame, iAnimation;
+    float ds, dt;
+};
+
+const float DT = 1.0f / 120.0f;
+const glm::vec2 LIMITE(1.0f, 0.75f);
+
+void moverAntigo(vector<SpriteAntigo> &s)
+{
+    for (SpriteAntigo &e : s)
+    {
+        e.prevPos = e.pos;
+        e.pos += e.vel * DT;
+    }
+    for (SpriteAntigo &e : s)
+    {
+        if (abs(e.pos.x) > LIMITE.x)
+            e.vel.x = -e.vel.x;
+        if (abs(e.pos.y) > LIMITE.y)
+            e.vel.y = -e.vel.y;
+    }
+}
+
+void animarAntigo(vector<SpriteAntigo> &s)
+{
+    for (SpriteAntigo &e : s)
+        e.iFrame = e.iFrame + 1 < e.nFrames ? e.iFrame + 1 : 0;
+}
+
+void retangulosAntigo(const vector<SpriteAntigo> &s, Rect *saida)
+{
+    for (size_t i = 0; i < s.size(); i++)
+        saida[i] = {s[i].pos, s[i].size};
+}
+
+void moverNovo(RegistroSprites &r)
+{
+    moverSprites(r, DT);
+    rebaterSprites(r, LIMITE);
+}
+
+// Repete fn até passar de cerca de 1 s; devolve milhões de entidades por segundo
+template <typename Funcao>
+double medir(size_t n, Funcao fn)
+{
+    int repeticoes = 0;
+    double t0 = agoraMs(), ms = 0.0;
+    do
+    {
+        fn();
+        repeticoes++;
+        ms = agoraMs() - t0;
+    } while (ms < 1000.0);
+    return (double)n * repeticoes / ms / 1000.0;
+}
+
+int main()
+{
+    const size_t n = 100000;
+
+    mt19937 rng(3);
+    uniform_real_distribution<float> coord(-1.0f, 1.0f), vel(-0.5f, 0.5f);
+    vector<SpriteAntigo> antigo(n);
+    RegistroSprites novo(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        SpriteAntigo &e = antigo[i];
+        e = SpriteAntigo();
+        e.pos = e.prevPos = glm::vec2(coord(rng), coord(rng) * 0.75f);
+        e.vel = glm::vec2(vel(rng), vel(rng));
+        e.size = glm::vec2(0.1f, 0.2f);
+        e.nFrames = 8;
+        e.nAnimations = 1;
+        e.iFrame = (int)(i % 8);
+
+        size_t j = novo.indice(novo.criar());
+        novo.posicao[j] = novo.posicaoAnterior[j] = e.pos;
+        novo.velocidade[j] = e.vel;
+        novo.tamanhoSprite[j] = e.size;
+        novo.animacao[j] = {e.iFrame, e.nFrames};
+    }
+    vector<Rect> rects(n);
+
+    printf("%zu entidades, sizeof(SpriteAntigo) = %zu bytes\n\n", n, sizeof(SpriteAntigo));
+    printf("%14s | %14s | %10s | %s\n", "antigo Ment/s", "SoA Ment/s", "aceleração", "laço");
+    printf("---------------+----------------+-----------+-----------\n");
+
+    struct Laco
+    {
+        const char *nome;
+        double antigo, novo;
+    } lacos[] = {
+        {"movimento", medir(n, [&] { moverAntigo(antigo); }), medir(n, [&] { moverNovo(novo); })},
+        {"animação", medir(n, [&] { animarAntigo(antigo); }), medir(n, [&] { animarSprites(novo); })},
+        {"retângulos", medir(n, [&] { retangulosAntigo(antigo, rects.data()); }),
+         medir(n, [&] { retangulosSprites(novo, rects.data()); })},
+        {"tick", medir(n, [&] { moverAntigo(antigo); animarAntigo(antigo); retangulosAntigo(antigo, rects.data()); }),
+         medir(n, [&] { moverNovo(novo); animarSprites(novo); retangulosSprites(novo, rects.data()); })},
+    };
+    for (const Laco &l : lacos)
+        printf("%14.1f | %14.1f | %9.1fx | %s\n", l.antigo, l.novo, l.novo / l.antigo, l.nome);
+
+    // as duas disposições rodaram laços diferentes número de vezes; refaz com um número fixo
+    for (size_t i = 0; i < n; i++)
+    {
+        novo.posicao[i] = novo.posicaoAnterior[i] = antigo[i].pos;
+        novo.velocidade[i] = antigo[i].vel;
+        novo.animacao[i].quadro = antigo[i].iFrame;
+    }
+    for (int t = 0; t < 1000; t++)
+    {
+        moverAntigo(antigo);
+        animarAntigo(antigo);
+        moverNovo(novo);
+        animarSprites(novo);
+    }
+    bool igual = true;
+    for (size_t i = 0; i < n; i++)
+        igual = igual && antigo[i].pos == novo.posicao[i] && antigo[i].vel == novo.velocidade[i] &&
+                antigo[i].iFrame == novo.animacao[i].quadro;
+    printf("\nEstado depois de 1000 ticks: %s\n", igual ? "igual" : "DIFERENTE");
+    return igual ? 0 : 1;
+}
@@ -6,12 +6,42 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include "ProgramaShader.h"
+#include "AtlasSprites.h"
+#include "RegistroSprites.h"
+#include "HashEspacial.h"
+
 #include <iostream>
 #include <vector>
 #include <cstdlib>
 #include <ctime>
 #include <cmath>
 #include <algorithm>
+#include <cstdio>
+#include <cstddef>
+
+#ifndef NDEBUG
+#include <atomic>
+#include <cassert>
+#include <new>
+
+// Contador de alocações (só em debug): o operator new global conta cada alocação no heap, e o
+// laço do jogo confere que a atualização e o lote de cada frame não alocam depois de estabilizar.
+// O contador vale para o processo inteiro, então o laço só o lê em volta do código do jogo:
+// o que o driver e o GLFW alocam (glfwPollEvents, glBufferData, compilar uma variante de shader
+// tarde, glfwSwapBuffers...) fica de fora de propósito
+std::atomic<size_t> heapAllocations{0};
+
+void* operator new(std::size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+#endif
 
 using namespace std;
 using namespace glm;
@@ -19,40 +49,45 @@ using namespace glm;
 const GLuint WIDTH = 800, HEIGHT = 600;
 
 struct Sprite {
-    GLuint VAO;
-    GLuint texID;
+    int region = 0; // folha de sprites no atlas
     vec2 pos;
+    vec2 prevPos;   // posição no tick anterior, para interpolar o desenho
     vec2 size;
     float angle = 0.0f;
     int nFrames = 1;
     int nAnimations = 1;
     int iFrame = 0;
     int iAnimation = 0;
-    float ds = 1.0f, dt = 1.0f;
 };
 
-struct Rect {
+// Dados de um sprite no lote, lidos pelo vertex shader uma vez por instância
+struct SpriteInstance {
     vec2 pos;
     vec2 size;
-
-    bool intersects(const Rect& other) {
-        return abs(pos.x - other.pos.x) < (size.x + other.size.x) / 2.0f &&
-               abs(pos.y - other.pos.y) < (size.y + other.size.y) / 2.0f;
-    }
+    float angle; // radianos
+    vec4 uv;     // canto e tamanho do quadro atual no atlas
 };
 
+// O quad unitário é o mesmo para todos os sprites; posição, tamanho, ângulo e o quadro da
+// folha no atlas vêm por instância
 const char* vertexShaderSource = R"(
 #version 400
 layout (location = 0) in vec2 position;
 layout (location = 1) in vec2 texCoord;
+layout (location = 2) in vec2 iPos;
+layout (location = 3) in vec2 iSize;
+layout (location = 4) in float iAngle;
+layout (location = 5) in vec4 iUV;
 
-uniform mat4 projection;
-uniform mat4 model;
+layout (std140) uniform Camera { mat4 view; mat4 proj; };
 out vec2 tex_coord;
 
 void main() {
-    tex_coord = texCoord;
-    gl_Position = projection * model * vec4(position, 0.0, 1.0);
+    float c = cos(iAngle), s = sin(iAngle);
+    vec2 p = position * iSize;
+    p = vec2(c * p.x - s * p.y, s * p.x + c * p.y) + iPos;
+    tex_coord = iUV.xy + texCoord * iUV.zw;
+    gl_Position = proj * view * vec4(p, 0.0, 1.0);
 }
 )";
 
@@ -61,169 +96,267 @@ const char* fragmentShaderSource = R"(
 in vec2 tex_coord;
 out vec4 color;
 uniform sampler2D tex_buff;
-uniform vec2 offset_tex;
 
 void main() {
-    color = texture(tex_buff, tex_coord + offset_tex);
+    color = texture(tex_buff, tex_coord);
 }
 )";
 
-GLuint compileShaders();
-GLuint setupSpriteVAO(float& ds, float& dt, int nFrames, int nAnimations);
-int loadTexture(string filePath);
-void drawSprite(GLuint shaderID, const Sprite& spr);
+int loadIntoAtlas(AtlasSprites& atlas, string filePath);
+GLuint createAtlasTexture(const AtlasSprites& atlas);
 
 void key_callback(GLFWwindow* window, int key, int, int action, int);
 bool keys[1024];
 
-GLuint compileShaders() {
-    GLint success;
-    GLchar infoLog[512];
-
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-    glCompileShader(vertexShader);
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        std::cerr << "Erro ao compilar Vertex Shader:\n" << infoLog << std::endl;
+// Lote de sprites: todos os sprites do frame (fundo, jogador e inimigos, nessa ordem) vão para
+// um buffer de instâncias e são desenhados com uma única chamada, com o atlas como textura
+struct SpriteBatch {
+    GLuint VAO = 0, quadVBO = 0, instanceVBO = 0;
+    size_t capacity = 0;
+    vector<SpriteInstance> instances;
+
+    void create() {
+        // quad unitário centrado na origem: posição e coordenada de textura (0 a 1 no quadro)
+        float vertices[] = {
+            -0.5f,  0.5f, 0.0f, 1.0f,
+            -0.5f, -0.5f, 0.0f, 0.0f,
+             0.5f,  0.5f, 1.0f, 1.0f,
+            -0.5f, -0.5f, 0.0f, 0.0f,
+             0.5f, -0.5f, 1.0f, 0.0f,
+             0.5f,  0.5f, 1.0f, 1.0f
+        };
+
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &quadVBO);
+        glGenBuffers(1, &instanceVBO);
+
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        GLsizei stride = sizeof(SpriteInstance);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(SpriteInstance, pos));
+        glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(SpriteInstance, size));
+        glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(SpriteInstance, angle));
+        glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(SpriteInstance, uv));
+        for (GLuint i = 2; i <= 5; i++) {
+            glEnableVertexAttribArray(i);
+            glVertexAttribDivisor(i, 1);
+        }
+
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        std::cerr << "Erro ao compilar Fragment Shader:\n" << infoLog << std::endl;
+    // alpha interpola entre a posição do tick anterior (0) e a do atual (1)
+    void add(const Sprite& spr, const AtlasSprites& atlas, float alpha = 1.0f) {
+        instances.push_back({mix(spr.prevPos, spr.pos, alpha), spr.size, radians(spr.angle),
+                             atlas.uvQuadro(spr.region, spr.iFrame, spr.iAnimation, spr.nFrames, spr.nAnimations)});
     }
 
-    GLuint shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success) {
-        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-        std::cerr << "Erro ao linkar Shader Program:\n" << infoLog << std::endl;
+    // Todas as entidades do registro, na ordem dos vetores
+    void addAll(const RegistroSprites& reg, const AtlasSprites& atlas, float alpha = 1.0f) {
+        for (size_t i = 0; i < reg.tamanho(); i++) {
+            const VisualSprite& v = reg.visual[i];
+            const AnimacaoSprite& a = reg.animacao[i];
+            instances.push_back({mix(reg.posicaoAnterior[i], reg.posicao[i], alpha), reg.tamanhoSprite[i], radians(v.angulo),
+                                 atlas.uvQuadro(v.regiao, a.quadro, v.linha, a.nQuadros, v.nLinhas)});
+        }
     }
 
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    // Envia as instâncias do frame e desenha todas de uma vez; a lista fica vazia para o próximo
+    void draw() {
+        if (instances.empty())
+            return;
+
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        GLsizeiptr bytes = (GLsizeiptr)(instances.size() * sizeof(SpriteInstance));
+        if (instances.size() > capacity)
+            capacity = std::max(instances.size(), 2 * capacity);
+        // realoca sempre: descarta o conteúdo do frame anterior sem esperar a GPU terminar de lê-lo
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(capacity * sizeof(SpriteInstance)), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, instances.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        glBindVertexArray(VAO);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 6, (GLsizei)instances.size());
+        glBindVertexArray(0);
+        instances.clear();
+    }
+};
 
-    return shaderProgram;
+// Carrega a imagem como RGBA e a guarda no atlas; devolve a região dela
+int loadIntoAtlas(AtlasSprites& atlas, string filePath) {
+    int width, height, nrChannels;
+    unsigned char* data = stbi_load(filePath.c_str(), &width, &height, &nrChannels, 4);
+    if (!data) {
+        std::cout << "Failed to load texture" << std::endl;
+        unsigned char transparente[4] = {0, 0, 0, 0};
+        return atlas.adicionar(transparente, 1, 1);
+    }
+    int region = atlas.adicionar(data, width, height);
+    stbi_image_free(data);
+    return region;
 }
 
-void drawSprite(GLuint shaderID, const Sprite& spr) {
-    glBindVertexArray(spr.VAO);
-    glBindTexture(GL_TEXTURE_2D, spr.texID);
-
-    mat4 model = mat4(1.0f);
-    model = translate(model, vec3(spr.pos, 0.0f));
-    model = rotate(model, radians(spr.angle), vec3(0.0f, 0.0f, 1.0f));
-    model = scale(model, vec3(spr.size, 1.0f));
+GLuint createAtlasTexture(const AtlasSprites& atlas) {
+    GLuint texID;
+    glGenTextures(1, &texID);
+    glBindTexture(GL_TEXTURE_2D, texID);
 
-    glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, value_ptr(model));
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    // sem mipmaps: os níveis menores misturariam as imagens vizinhas do atlas
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
-    glBindVertexArray(0);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, atlas.largura, atlas.altura, 0, GL_RGBA, GL_UNSIGNED_BYTE, atlas.pixels.data());
+    return texID;
 }
 
-GLuint setupSpriteVAO(float& ds, float& dt, int nFrames, int nAnimations) {
-    ds = 1.0f / nFrames;
-    dt = 1.0f / nAnimations;
+// Inimigos vivos ao mesmo tempo: um novo a cada 1 a 2,5 s, e cada um atravessa a tela em 2,4 s
+const size_t MAX_ENEMIES = 16;
 
-    float vertices[] = {     
-        -0.5f,  0.5f, 0.0f, dt,
-        -0.5f, -0.5f, 0.0f, 0.0f,
-         0.5f,  0.5f, ds,   dt,
-        -0.5f, -0.5f, 0.0f, 0.0f,
-         0.5f, -0.5f, ds,   0.0f,
-         0.5f,  0.5f, ds,   dt
-    };
+Sprite background, player;
+RegistroSprites enemies(MAX_ENEMIES);
 
-    GLuint VBO, VAO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
+// Broadphase das colisões: refeita a cada tick com os retângulos dos inimigos vivos; células do
+// tamanho do maior sprite, para cada retângulo cobrir no máximo 2 x 2 células
+HashEspacial enemyHash(0.2f);
+Rect enemyRects[MAX_ENEMIES];
 
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+// A simulação anda em passos fixos de 1/120 s, independentes do desenho; o desenho interpola
+// entre os dois últimos ticks. Com a mesma semente e o mesmo pulo nos mesmos ticks, a partida se
+// repete bit a bit
+const float FIXED_DT = 1.0f / 120.0f;
+const int TICKS_PER_ANIMATION_FRAME = 10; // 12 quadros de animação por segundo
+const double MAX_FRAME_TIME = 0.25;       // um frame muito lento não vira uma avalanche de ticks
 
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
+float gravity = -9.8f;
+float velocityY = 0.0f;
+bool isOnGround = true;
+bool jump = false;
+bool isGameOver = false;
+float obstacleTimer = 0.0f;
+float nextObstacleTime = 1.0f;
+uint64_t tick = 0;
 
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
+// Gerador do jogo (xorshift32), separado do rand() usado só no teste de carga
+uint32_t rngState = 1;
 
-    glBindVertexArray(0);
-    return VAO;
+float randomUnit() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return (rngState >> 8) * (1.0f / 16777216.0f); // [0, 1)
 }
 
-int loadTexture(string filePath)
-{
-	GLuint texID;
+// Frames sem alocação exigidos só depois deste aquecimento; recomeça quando o teste de carga muda
+const int WARMUP_FRAMES = 60;
+
+// Teste de carga (tecla T): sprites extras quicando pela tela, desenhados no mesmo lote
+const int STRESS_SPRITES = 10000;
+bool stressToggle = false;
+RegistroSprites stressSprites(STRESS_SPRITES);
+
+// Cria no registro uma entidade com a aparência e a animação de um sprite modelo; devolve o
+// índice dela, ou NENHUMA_ENTIDADE se o registro estiver cheio
+size_t spawnFrom(RegistroSprites& reg, const Sprite& base, vec2 pos, vec2 velocity) {
+    size_t i = reg.indice(reg.criar());
+    if (i == NENHUMA_ENTIDADE)
+        return i;
+    reg.posicao[i] = reg.posicaoAnterior[i] = pos;
+    reg.velocidade[i] = velocity;
+    reg.tamanhoSprite[i] = base.size;
+    reg.animacao[i] = {base.iFrame, base.nFrames};
+    reg.visual[i] = {base.region, base.angle, base.iAnimation, base.nAnimations};
+    return i;
+}
 
-	// Gera o identificador da textura na memória
-	glGenTextures(1, &texID);
-	glBindTexture(GL_TEXTURE_2D, texID);
+void fillStressSprites(const Sprite& a, const Sprite& b) {
+    auto random = [](float lo, float hi) { return lo + static_cast<float>(rand()) / RAND_MAX * (hi - lo); };
+    stressSprites.limpar();
+    for (int i = 0; i < STRESS_SPRITES; i++) {
+        size_t j = spawnFrom(stressSprites, (i % 2) ? a : b, vec2(random(-1.0f, 1.0f), random(-0.75f, 0.75f)),
+                             vec2(random(-0.5f, 0.5f), random(-0.5f, 0.5f)));
+        stressSprites.tamanhoSprite[j] = vec2(0.05f, 0.1f);
+        stressSprites.visual[j].angulo = random(0.0f, 360.0f);
+        stressSprites.animacao[j].quadro = i % stressSprites.animacao[j].nQuadros;
+    }
+}
 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    if (key == GLFW_KEY_SPACE && action == GLFW_PRESS && !isGameOver)
+        jump = true;
 
-	int width, height, nrChannels;
+    if (key == GLFW_KEY_T && action == GLFW_PRESS)
+        stressToggle = true;
+}
 
-	unsigned char *data = stbi_load(filePath.c_str(), &width, &height, &nrChannels, 0);
+// Um tick da simulação; o pulo pedido pelo teclado é lido aqui, no começo do tick
+void simulationStep(const Sprite& baseEnemy) {
+    player.prevPos = player.pos;
+    if (isGameOver) {
+        enemies.posicaoAnterior = enemies.posicao;
+        return;
+    }
+    tick++;
 
-	if (data)
-	{
-		if (nrChannels == 3) // jpg, bmp
-		{
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		}
-		else // png
-		{
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-		}
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
-	{
-		std::cout << "Failed to load texture" << std::endl;
-	}
+    if (jump && isOnGround) {
+        velocityY = 3.0f;
+        isOnGround = false;
+        jump = false;
+    }
 
-	stbi_image_free(data);
+    velocityY += gravity * FIXED_DT;
+    player.pos.y += velocityY * FIXED_DT;
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+    if (player.pos.y < -0.5f) {
+        player.pos.y = -0.5f;
+        velocityY = 0.0f;
+        isOnGround = true;
+    }
 
-	return texID;
-}
+    obstacleTimer += FIXED_DT;
+    if (obstacleTimer >= nextObstacleTime) {
+        obstacleTimer = 0.0f;
+        nextObstacleTime = 1.0f + randomUnit() * 1.5f;
+        spawnFrom(enemies, baseEnemy, vec2(1.2f, -0.5f), vec2(-1.0f, 0.0f));
+    }
 
+    moverSprites(enemies, FIXED_DT);
 
-Sprite background, player;
-vector<Sprite> enemies;
-float gravity = -9.8f;
-float velocityY = 0.0f;
-bool isOnGround = true;
-bool jump = false;
-bool isGameOver = false;
-float lastFrameTime = 0.0f;
-float frameInterval = 1.0f / 12.0f;
-float obstacleTimer = 0.0f;
+    enemies.removerSe([](size_t i) {
+        return enemies.posicao[i].x < -1.2f;
+    });
 
-void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
-    if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
-        glfwSetWindowShouldClose(window, true);
+    retangulosSprites(enemies, enemyRects);
+    enemyHash.construir(enemyRects, enemies.tamanho());
+    enemyHash.consultar({player.pos, player.size}, [](uint32_t) {
+        isGameOver = true;
+    });
 
-    if (key == GLFW_KEY_SPACE && action == GLFW_PRESS && !isGameOver)
-        jump = true;
+    if (tick % TICKS_PER_ANIMATION_FRAME == 0) {
+        player.iFrame = (player.iFrame + 1) % player.nFrames;
+        animarSprites(enemies);
+    }
 }
 
-int main() {
+// Uso: Game [semente]; sem semente, usa o relógio e a imprime, para a partida poder ser repetida
+int main(int argc, char** argv) {
     srand((unsigned)time(0));
+    rngState = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 10) : (uint32_t)time(0);
+    if (rngState == 0)
+        rngState = 1; // o xorshift nunca sai do zero
+    std::cout << "Seed: " << rngState << std::endl;
     glfwInit();
     glfwWindowHint(GLFW_SAMPLES, 8);
     stbi_set_flip_vertically_on_load(true);
@@ -232,111 +365,137 @@ int main() {
     glfwSetKeyCallback(window, key_callback);
     gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
 
-    GLuint shaderID = compileShaders();
-    glUseProgram(shaderID);
+    ProgramaShader shader(vertexShaderSource, fragmentShaderSource);
+    shader.usar();
 
+    BlocoCamera camera;
+    camera.criar();
     mat4 projection = ortho(-1.0f, 1.0f, -0.75f, 0.75f, -1.0f, 1.0f);
-    glUniformMatrix4fv(glGetUniformLocation(shaderID, "projection"), 1, GL_FALSE, value_ptr(projection));
-    glUniform1i(glGetUniformLocation(shaderID, "tex_buff"), 0);
+    camera.enviar(mat4(1.0f), projection);
+    glUniform1i(shader.uniform("tex_buff"), 0);
 
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    background.texID = loadTexture("../assets/sprites/Background.png");
+    AtlasSprites atlas;
+    background.region = loadIntoAtlas(atlas, "../assets/sprites/Background.png");
     background.size = vec2(2.0f, 1.5f);
-    background.VAO = setupSpriteVAO(background.ds, background.dt, 1, 1);
 
-    player.texID = loadTexture("../assets/sprites/sprite_dino.png");
+    player.region = loadIntoAtlas(atlas, "../assets/sprites/sprite_dino.png");
     player.size = vec2(0.1f, 0.2f);
-    player.pos = vec2(-0.8f, -0.5f);
+    player.pos = player.prevPos = vec2(-0.8f, -0.5f);
     player.nFrames = 8;
     player.nAnimations = 1;
-    player.VAO = setupSpriteVAO(player.ds, player.dt, player.nFrames, player.nAnimations);
 
     Sprite baseEnemy;
-    baseEnemy.texID = loadTexture("../assets/sprites/slimer-idle.png");
+    baseEnemy.region = loadIntoAtlas(atlas, "../assets/sprites/slimer-idle.png");
     baseEnemy.size = vec2(0.1f, 0.2f);
     baseEnemy.nFrames = 8;
     baseEnemy.nAnimations = 1;
-    baseEnemy.VAO = setupSpriteVAO(baseEnemy.ds, baseEnemy.dt, baseEnemy.nFrames, baseEnemy.nAnimations);
 
-    float lastTime = glfwGetTime();
-    float nextObstacleTime = 1.0f;
+    if (!atlas.montar())
+        std::cout << "Failed to build sprite atlas" << std::endl;
+    GLuint atlasTexture = createAtlasTexture(atlas);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, atlasTexture);
+
+    SpriteBatch batch;
+    batch.create();
+
+    // toda a memória do laço é reservada aqui, inclusive a do teste de carga
+    batch.instances.reserve(2 + MAX_ENEMIES + STRESS_SPRITES);
+    enemyHash.reservar(MAX_ENEMIES);
+#ifndef NDEBUG
+    int steadyFrames = 0;
+#endif
+
+    double lastTime = glfwGetTime();
+    double accumulator = 0.0;
+    float stressAnimationTime = 0.0f;
+    double fpsTime = lastTime;
+    int fpsFrames = 0;
 
     while (!glfwWindowShouldClose(window)) {
-        float currentTime = glfwGetTime();
-        float deltaTime = currentTime - lastTime;
+        double currentTime = glfwGetTime();
+        float deltaTime = (float)std::min(currentTime - lastTime, MAX_FRAME_TIME);
         lastTime = currentTime;
 
         glfwPollEvents();
 
-        if (!isGameOver) {
-            if (jump && isOnGround) {
-                velocityY = 3.0f;
-                isOnGround = false;
-                jump = false;
-            }
-
-            velocityY += gravity * deltaTime;
-            player.pos.y += velocityY * deltaTime;
-
-            if (player.pos.y < -0.5f) {
-                player.pos.y = -0.5f;
-                velocityY = 0.0f;
-                isOnGround = true;
-            }
-
-            obstacleTimer += deltaTime;
-            if (obstacleTimer >= nextObstacleTime) {
-                obstacleTimer = 0.0f;
-                nextObstacleTime = 1.0f + static_cast<float>(rand()) / RAND_MAX * 1.5f;
-                Sprite newEnemy = baseEnemy;
-                newEnemy.pos = vec2(1.2f, -0.5f);
-                enemies.push_back(newEnemy);
-            }
-
-            for (auto& e : enemies) {
-                e.pos.x -= 1.0f * deltaTime;
-            }
-
-            enemies.erase(remove_if(enemies.begin(), enemies.end(), [](Sprite& e) {
-                return e.pos.x < -1.2f;
-            }), enemies.end());
-
-            for (const auto& e : enemies) {
-                Rect r1 = {player.pos, player.size};
-                Rect r2 = {e.pos, e.size};
-                if (r1.intersects(r2)) {
-                    isGameOver = true;
-                }
-            }
-
-            float now = glfwGetTime();
-            if (now - lastFrameTime >= frameInterval) {
-                player.iFrame = (player.iFrame + 1) % player.nFrames;
-                for (auto& e : enemies)
-                    e.iFrame = (e.iFrame + 1) % e.nFrames;
-                lastFrameTime = now;
-            }
+        if (stressToggle) {
+            stressToggle = false;
+#ifndef NDEBUG
+            steadyFrames = 0;
+#endif
+            if (stressSprites.tamanho() == 0)
+                fillStressSprites(player, baseEnemy);
+            else
+                stressSprites.limpar();
+        }
+
+#ifndef NDEBUG
+        size_t allocationsBefore = heapAllocations.load(std::memory_order_relaxed);
+#endif
+
+        // os sprites do teste de carga são só visuais: andam, giram e animam com o tempo do frame, fora da simulação
+        moverSprites(stressSprites, deltaTime);
+        rebaterSprites(stressSprites, vec2(1.0f, 0.75f));
+        for (VisualSprite& v : stressSprites.visual)
+            v.angulo += 90.0f * deltaTime;
+        stressAnimationTime += deltaTime;
+        while (stressAnimationTime >= TICKS_PER_ANIMATION_FRAME * FIXED_DT) {
+            animarSprites(stressSprites);
+            stressAnimationTime -= TICKS_PER_ANIMATION_FRAME * FIXED_DT;
+        }
+
+        accumulator += deltaTime;
+        while (accumulator >= FIXED_DT) {
+            simulationStep(baseEnemy);
+            accumulator -= FIXED_DT;
         }
+        float alpha = (float)(accumulator / FIXED_DT);
+
+#ifndef NDEBUG
+        size_t gameAllocations = heapAllocations.load(std::memory_order_relaxed) - allocationsBefore;
+#endif
 
         glClearColor(0, 0, 0, 1);
         glClear(GL_COLOR_BUFFER_BIT);
 
-        glUniform2f(glGetUniformLocation(shaderID, "offset_tex"), 0.0f, 0.0f);
-        drawSprite(shaderID, background);
+#ifndef NDEBUG
+        allocationsBefore = heapAllocations.load(std::memory_order_relaxed);
+#endif
+
+        // a ordem no lote é a ordem de desenho: fundo, jogador, inimigos
+        batch.add(background, atlas);
+        batch.add(player, atlas, alpha);
+        batch.addAll(enemies, atlas, alpha);
+        batch.addAll(stressSprites, atlas);
+        size_t spriteCount = batch.instances.size();
+#ifndef NDEBUG
+        gameAllocations += heapAllocations.load(std::memory_order_relaxed) - allocationsBefore;
+        if (steadyFrames >= WARMUP_FRAMES)
+            assert(gameAllocations == 0 && "heap allocation in the game loop");
+        else
+            steadyFrames++;
+#endif
+        batch.draw();
 
-        glUniform2f(glGetUniformLocation(shaderID, "offset_tex"), player.iFrame * player.ds, player.iAnimation * player.dt);
-        drawSprite(shaderID, player);
+        glfwSwapBuffers(window);
 
-        for (const auto& e : enemies) {
-            glUniform2f(glGetUniformLocation(shaderID, "offset_tex"), e.iFrame * e.ds, e.iAnimation * e.dt);
-            drawSprite(shaderID, e);
+        fpsFrames++;
+        if (currentTime - fpsTime >= 1.0f) {
+            char title[128];
+            snprintf(title, sizeof(title), "Endless Runner - %zu sprites - %.0f fps", spriteCount,
+                     fpsFrames / (currentTime - fpsTime));
+            glfwSetWindowTitle(window, title);
+            fpsTime = currentTime;
+            fpsFrames = 0;
         }
-
-        glfwSwapBuffers(window);
     }
 
+    glDeleteTextures(1, &atlasTexture);
+    camera.destruir();
     glfwTerminate();
     return 0;
 }
\ No newline at end of file
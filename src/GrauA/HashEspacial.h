@@ -0,0 +1,161 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+#include <glm/glm.hpp>
+
+// Broadphase de colisões por hash espacial: o plano é dividido numa grade uniforme de células
+// e cada retângulo entra em todas as células que cobre. Só retângulos na mesma célula viram
+// candidatos, e só os candidatos passam pelo teste exato de Rect (narrowphase).
+// A tabela é refeita a cada tick por ordenação por contagem (conta por balde, soma prefixa,
+// distribui), sem listas encadeadas; depois de reservar, refazer não aloca.
+// Um par que divide várias células é informado uma vez só: na célula que contém o canto
+// mínimo da interseção dos dois retângulos. Células diferentes podem cair no mesmo balde da
+// tabela, por isso cada entrada guarda também a sua célula.
+// Aqui não há OpenGL.
+
+struct Rect {
+    glm::vec2 pos;  // centro
+    glm::vec2 size;
+
+    bool intersects(const Rect& other) const {
+        return std::abs(pos.x - other.pos.x) < (size.x + other.size.x) / 2.0f &&
+               std::abs(pos.y - other.pos.y) < (size.y + other.size.y) / 2.0f;
+    }
+};
+
+class HashEspacial {
+public:
+    // tamanhoCelula perto do tamanho típico dos retângulos: menor, cada um ocupa muitas
+    // células; maior, cada célula junta muitos candidatos
+    explicit HashEspacial(float tamanhoCelula) : inverso(1.0f / tamanhoCelula) {}
+
+    // Reserva memória para até maxEntidades retângulos ocupando em média celulasPorEntidade
+    void reservar(size_t maxEntidades, size_t celulasPorEntidade = 4) {
+        rects.reserve(maxEntidades);
+        faixas.reserve(maxEntidades);
+        entradas.reserve(maxEntidades * celulasPorEntidade);
+        inicio.reserve(baldesPara(maxEntidades * celulasPorEntidade) + 1);
+    }
+
+    void construir(const Rect* r, size_t n) {
+        rects.assign(r, r + n);
+        faixas.resize(n);
+
+        size_t total = 0;
+        for (size_t i = 0; i < n; i++) {
+            Celulas c = faixas[i] = celulas(rects[i]);
+            total += (size_t)(c.x1 - c.x0 + 1) * (size_t)(c.y1 - c.y0 + 1);
+        }
+        nBaldes = baldesPara(total);
+        inicio.assign(nBaldes + 1, 0);
+        entradas.resize(total);
+
+        // conta, soma prefixa e distribui; no fim inicio[b] é o começo do balde b
+        for (const Celulas& c : faixas) {
+            for (int32_t y = c.y0; y <= c.y1; y++)
+                for (int32_t x = c.x0; x <= c.x1; x++)
+                    inicio[balde(x, y) + 1]++;
+        }
+        for (size_t b = 0; b < nBaldes; b++)
+            inicio[b + 1] += inicio[b];
+        for (size_t i = 0; i < n; i++) {
+            const Celulas& c = faixas[i];
+            for (int32_t y = c.y0; y <= c.y1; y++)
+                for (int32_t x = c.x0; x <= c.x1; x++)
+                    entradas[inicio[balde(x, y)]++] = {x, y, (uint32_t)i};
+        }
+        for (size_t b = nBaldes; b > 0; b--)
+            inicio[b] = inicio[b - 1];
+        inicio[0] = 0;
+    }
+
+    size_t tamanho() const { return rects.size(); }
+
+    // Chama fn(i, j), com i < j, para cada par de retângulos que se intersectam; devolve
+    // quantos pares candidatos passaram pelo teste exato
+    template <typename Funcao>
+    size_t paraCadaPar(Funcao fn) const {
+        size_t testes = 0;
+        for (size_t b = 0; b < nBaldes; b++) {
+            for (uint32_t i = inicio[b]; i < inicio[b + 1]; i++) {
+                const Entrada& ei = entradas[i];
+                for (uint32_t j = i + 1; j < inicio[b + 1]; j++) {
+                    const Entrada& ej = entradas[j];
+                    if (ej.x != ei.x || ej.y != ei.y)
+                        continue;
+                    const Rect &a = rects[ei.id], &c = rects[ej.id];
+                    testes++;
+                    if (a.intersects(c) && donoDoPar(a, c, ei.x, ei.y))
+                        fn(std::min(ei.id, ej.id), std::max(ei.id, ej.id));
+                }
+            }
+        }
+        return testes;
+    }
+
+    // Chama fn(i) para cada retângulo da tabela que intersecta r
+    template <typename Funcao>
+    void consultar(const Rect& r, Funcao fn) const {
+        if (nBaldes == 0)
+            return;
+        Celulas c = celulas(r);
+        for (int32_t y = c.y0; y <= c.y1; y++)
+            for (int32_t x = c.x0; x <= c.x1; x++) {
+                size_t b = balde(x, y);
+                for (uint32_t i = inicio[b]; i < inicio[b + 1]; i++) {
+                    const Entrada& e = entradas[i];
+                    if (e.x == x && e.y == y && rects[e.id].intersects(r) && donoDoPar(rects[e.id], r, x, y))
+                        fn(e.id);
+                }
+            }
+    }
+
+private:
+    struct Entrada {
+        int32_t x, y; // célula
+        uint32_t id;  // índice do retângulo
+    };
+
+    struct Celulas {
+        int32_t x0, y0, x1, y1;
+    };
+
+    float inverso;
+    size_t nBaldes = 0;
+    std::vector<Rect> rects;
+    std::vector<Celulas> faixas; // células cobertas por cada retângulo
+    std::vector<uint32_t> inicio;
+    std::vector<Entrada> entradas;
+
+    static size_t baldesPara(size_t entradas) {
+        size_t n = 16;
+        while (n < entradas)
+            n *= 2;
+        return n;
+    }
+
+    static glm::vec2 minimo(const Rect& r) { return r.pos - r.size * 0.5f; }
+    static glm::vec2 maximo(const Rect& r) { return r.pos + r.size * 0.5f; }
+
+    int32_t celula(float v) const { return (int32_t)std::floor(v * inverso); }
+
+    Celulas celulas(const Rect& r) const {
+        glm::vec2 a = minimo(r), b = maximo(r);
+        return {celula(a.x), celula(a.y), celula(b.x), celula(b.y)};
+    }
+
+    size_t balde(int32_t x, int32_t y) const {
+        uint32_t h = (uint32_t)x * 73856093u ^ (uint32_t)y * 19349663u;
+        return h & (nBaldes - 1);
+    }
+
+    // O par pertence à célula do canto mínimo da interseção, que está nas duas faixas de células
+    bool donoDoPar(const Rect& a, const Rect& b, int32_t x, int32_t y) const {
+        glm::vec2 canto = glm::max(minimo(a), minimo(b));
+        return celula(canto.x) == x && celula(canto.y) == y;
+    }
+};
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <glm/glm.hpp>
+
+#include "HashEspacial.h"
+
+// Registro de entidades-sprite em estrutura de arrays: cada componente (posição, velocidade,
+// animação, dados de desenho) fica num vetor denso próprio, todos na mesma ordem, e cada laço
+// do jogo percorre só os vetores de que precisa. Remover troca a entidade com a última e
+// encurta todos os vetores, então os vivos continuam contíguos e a ordem não é preservada.
+// Entidades são identificadas por Entidade (vaga + geração), que continua válida quando a
+// entidade muda de posição nos vetores e deixa de valer quando ela é removida; as vagas livres
+// são reutilizadas em pilha. Toda a memória é reservada na construção, então criar e remover
+// não alocam. Aqui não há OpenGL.
+
+struct Entidade
+{
+    uint32_t vaga = UINT32_MAX;
+    uint32_t geracao = 0;
+};
+
+// Quadro atual da folha de sprites: o único estado que o laço de animação toca
+struct AnimacaoSprite
+{
+    int quadro = 0;
+    int nQuadros = 1;
+};
+
+// O que só o desenho lê
+struct VisualSprite
+{
+    int regiao = 0;      // folha de sprites no atlas
+    float angulo = 0.0f; // graus
+    int linha = 0;       // animação atual (linha da folha)
+    int nLinhas = 1;
+};
+
+const size_t NENHUMA_ENTIDADE = SIZE_MAX;
+
+class RegistroSprites
+{
+public:
+    explicit RegistroSprites(size_t capacidade) : capacidade(capacidade)
+    {
+        posicao.reserve(capacidade);
+        posicaoAnterior.reserve(capacidade);
+        velocidade.reserve(capacidade);
+        tamanhoSprite.reserve(capacidade);
+        animacao.reserve(capacidade);
+        visual.reserve(capacidade);
+        donos.reserve(capacidade);
+        densoDaVaga.assign(capacidade, 0);
+        geracoes.assign(capacidade, 0);
+        livres.reserve(capacidade);
+        limpar();
+    }
+
+    // Acrescenta uma entidade no fim dos vetores (índice tamanho() - 1, componentes zerados);
+    // devolve uma Entidade inválida se o registro estiver cheio
+    Entidade criar()
+    {
+        if (livres.empty())
+            return Entidade();
+        uint32_t vaga = livres.back();
+        livres.pop_back();
+        densoDaVaga[vaga] = (uint32_t)donos.size();
+        donos.push_back(vaga);
+        posicao.push_back(glm::vec2(0.0f));
+        posicaoAnterior.push_back(glm::vec2(0.0f));
+        velocidade.push_back(glm::vec2(0.0f));
+        tamanhoSprite.push_back(glm::vec2(0.0f));
+        animacao.push_back(AnimacaoSprite());
+        visual.push_back(VisualSprite());
+        return {vaga, geracoes[vaga]};
+    }
+
+    // Índice atual da entidade nos vetores, ou NENHUMA_ENTIDADE se ela já foi removida
+    size_t indice(Entidade e) const
+    {
+        if (e.vaga >= capacidade || geracoes[e.vaga] != e.geracao)
+            return NENHUMA_ENTIDADE;
+        return densoDaVaga[e.vaga];
+    }
+
+    Entidade entidade(size_t i) const { return {donos[i], geracoes[donos[i]]}; }
+
+    // Remove a entidade de índice i; a última passa a ocupar o índice i
+    void remover(size_t i)
+    {
+        size_t ultimo = donos.size() - 1;
+        uint32_t vaga = donos[i];
+        geracoes[vaga]++;
+        livres.push_back(vaga);
+        if (i != ultimo)
+        {
+            donos[i] = donos[ultimo];
+            densoDaVaga[donos[i]] = (uint32_t)i;
+            posicao[i] = posicao[ultimo];
+            posicaoAnterior[i] = posicaoAnterior[ultimo];
+            velocidade[i] = velocidade[ultimo];
+            tamanhoSprite[i] = tamanhoSprite[ultimo];
+            animacao[i] = animacao[ultimo];
+            visual[i] = visual[ultimo];
+        }
+        donos.pop_back();
+        posicao.pop_back();
+        posicaoAnterior.pop_back();
+        velocidade.pop_back();
+        tamanhoSprite.pop_back();
+        animacao.pop_back();
+        visual.pop_back();
+    }
+
+    // Remove as entidades de índice i para as quais pred(i) é verdadeiro
+    template <typename Predicado>
+    void removerSe(Predicado pred)
+    {
+        for (size_t i = 0; i < donos.size();)
+        {
+            if (pred(i))
+                remover(i); // a entidade trazida para i ainda precisa ser testada
+            else
+                i++;
+        }
+    }
+
+    void limpar()
+    {
+        for (size_t i = 0; i < donos.size(); i++)
+            geracoes[donos[i]]++;
+        donos.clear();
+        posicao.clear();
+        posicaoAnterior.clear();
+        velocidade.clear();
+        tamanhoSprite.clear();
+        animacao.clear();
+        visual.clear();
+        livres.clear();
+        for (size_t i = 0; i < capacidade; i++)
+            livres.push_back((uint32_t)(capacidade - 1 - i)); // a vaga 0 sai primeiro
+    }
+
+    size_t tamanho() const { return donos.size(); }
+
+    // Componentes, todos com tamanho() elementos
+    std::vector<glm::vec2> posicao;
+    std::vector<glm::vec2> posicaoAnterior; // do tick anterior, para interpolar o desenho
+    std::vector<glm::vec2> velocidade;
+    std::vector<glm::vec2> tamanhoSprite;
+    std::vector<AnimacaoSprite> animacao;
+    std::vector<VisualSprite> visual;
+
+private:
+    size_t capacidade;
+    std::vector<uint32_t> donos;       // vaga de cada índice denso
+    std::vector<uint32_t> densoDaVaga; // índice denso de cada vaga ocupada
+    std::vector<uint32_t> geracoes;    // muda a cada remoção, invalidando as Entidades antigas
+    std::vector<uint32_t> livres;
+};
+
+// Sistemas: cada um percorre só os componentes que usa
+
+// Guarda a posição do tick anterior e avança pela velocidade
+inline void moverSprites(RegistroSprites &r, float dt)
+{
+    size_t n = r.tamanho();
+    glm::vec2 *pos = r.posicao.data(), *anterior = r.posicaoAnterior.data();
+    const glm::vec2 *vel = r.velocidade.data();
+    for (size_t i = 0; i < n; i++)
+    {
+        anterior[i] = pos[i];
+        pos[i] += vel[i] * dt;
+    }
+}
+
+// Inverte a velocidade de quem saiu do retângulo [-limite, limite]
+inline void rebaterSprites(RegistroSprites &r, glm::vec2 limite)
+{
+    size_t n = r.tamanho();
+    const glm::vec2 *pos = r.posicao.data();
+    glm::vec2 *vel = r.velocidade.data();
+    for (size_t i = 0; i < n; i++)
+    {
+        if (std::abs(pos[i].x) > limite.x)
+            vel[i].x = -vel[i].x;
+        if (std::abs(pos[i].y) > limite.y)
+            vel[i].y = -vel[i].y;
+    }
+}
+
+// Avança um quadro da animação de todos
+inline void animarSprites(RegistroSprites &r)
+{
+    for (AnimacaoSprite &a : r.animacao)
+        a.quadro = a.quadro + 1 < a.nQuadros ? a.quadro + 1 : 0;
+}
+
+// Escreve em saida (capacidade para tamanho() retângulos) o retângulo de colisão de cada um
+inline void retangulosSprites(const RegistroSprites &r, Rect *saida)
+{
+    size_t n = r.tamanho();
+    for (size_t i = 0; i < n; i++)
+        saida[i] = {r.posicao[i], r.tamanhoSprite[i]};
+}
@@ -0,0 +1,622 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <atomic>
+#include <glm/glm.hpp>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "GradeVoxel.h"
+
+// Leitura e escrita da grade de voxels em disco.
+//
+// Formato texto (importação / exportação): TAM na primeira linha e depois uma linha por voxel
+// com sete campos "x y z escala visivel selecionado cor"; só os voxels visíveis são gravados.
+//
+// Formato binário (versão 1), todos os inteiros em little-endian:
+//   cabeçalho: "VOXB", versão (u16), reservado (u16), tam (i32), nCores (u32), nChunks (u32)
+//   paleta:    nCores × 4 floats (rgba)
+//   chunks:    cx, cy, cz (i32), nCorridas (u32) e nCorridas × [comprimento (u16), valor (u8)]
+// Cada chunk é codificado em corridas (RLE) na ordem de indiceLocal; valor VAZIO marca voxel invisível.
+//
+// Também importa modelos .vox do MagicaVoxel (ver carregarGradeVox, no fim do arquivo).
+//
+// Todas as funções aceitam um ponteiro opcional de progresso (0 a 1), para que possam rodar
+// em uma thread de trabalho enquanto o editor mostra o andamento.
+
+const char MAGICO_VOXB[4] = {'V', 'O', 'X', 'B'};
+const uint16_t VERSAO_VOXB = 1;
+const uint8_t VAZIO_VOXB = 0xFF;
+const uint32_t MAX_CORES_VOXB = 256;
+
+// Cores da paleta do editor (colorList e uPaleta nos shaders): um índice de cor lido de arquivo
+// fora dela faria o desenho e a exportação lerem além do fim da paleta
+const int CORES_EDITOR = 10;
+
+// ---------------------------------------------------------------------------------------------
+// Formato texto
+
+inline void informarProgresso(std::atomic<float> *progresso, float valor)
+{
+    if (progresso)
+        progresso->store(valor, std::memory_order_relaxed);
+}
+
+inline bool salvarGradeTexto(const GradeVoxel &grade, const std::string &nomeArquivo, glm::ivec3 selecao,
+                             std::atomic<float> *progresso = nullptr)
+{
+    std::ofstream arquivo(nomeArquivo);
+    if (!arquivo.is_open())
+    {
+        std::cerr << "Erro ao abrir arquivo para escrita.\n";
+        return false;
+    }
+
+    arquivo << grade.tam << "\n"; //grava no arquivo o tamanho da matriz tridimensional na primeira linha
+
+    // a posição de cada linha identifica o voxel, então os vazios podem ser omitidos
+    size_t chunksGravados = 0;
+    for (const auto &par : grade.chunks)
+    {
+        GradeVoxel::paraCadaVoxelDoChunk(*par.second, [&](int x, int y, int z, const Voxel &v)
+        {
+            glm::vec3 pos = grade.posicao(x, y, z);
+            bool selecionado = x == selecao.x && y == selecao.y && z == selecao.z;
+            arquivo << pos.x << " " << pos.y << " " << pos.z << " "
+                    << FATOR_ESCALA_VOXEL << " "
+                    << (int)v.visivel << " " << (int)selecionado << " "
+                    << (int)v.corPos << "\n";
+        });
+        informarProgresso(progresso, (float)++chunksGravados / grade.chunks.size());
+    }
+
+    informarProgresso(progresso, 1.0f);
+    return true;
+}
+
+// Lê os voxels até o fim do arquivo; tanto arquivos densos (todos os voxels) quanto esparsos
+// (só os visíveis) funcionam. selecao recebe o voxel marcado como selecionado, se houver.
+inline bool carregarGradeTexto(GradeVoxel &grade, const std::string &nomeArquivo, glm::ivec3 &selecao,
+                               std::atomic<float> *progresso = nullptr)
+{
+    std::ifstream arquivo(nomeArquivo);
+    if (!arquivo.is_open())
+    {
+        std::cerr << "Erro ao abrir arquivo para leitura.\n";
+        return false;
+    }
+
+    arquivo.seekg(0, std::ios::end);
+    double tamanhoArquivo = (double)arquivo.tellg();
+    arquivo.seekg(0, std::ios::beg);
+
+    int tamanho;
+    if (!(arquivo >> tamanho) || tamanho <= 0)
+    {
+        std::cerr << "Arquivo de voxels inválido: " << nomeArquivo << "\n";
+        return false;
+    }
+    grade.redimensionar(tamanho);
+
+    glm::vec3 pos;
+    float fatorEscala;
+    int visivel, selecionado, corPos;
+    size_t linhas = 0;
+    bool corrompido = false;
+    while (arquivo >> pos.x >> pos.y >> pos.z >> fatorEscala >> visivel >> selecionado >> corPos)
+    {
+        if (progresso && (++linhas & 0xFFFF) == 0)
+            informarProgresso(progresso, (float)(arquivo.tellg() / tamanhoArquivo));
+
+        int x = (int)std::lround(pos.x) + tamanho / 2;
+        int y = (int)std::lround(pos.y) + tamanho / 2;
+        int z = (int)std::lround(pos.z) + tamanho / 2;
+        if (!grade.dentro(x, y, z))
+            continue;
+
+        if (visivel)
+        {
+            if (corPos < 0 || corPos >= CORES_EDITOR)
+            {
+                corrompido = true;
+                break;
+            }
+            Voxel v;
+            v.visivel = 1;
+            v.corPos = (uint8_t)corPos;
+            grade.escrever(x, y, z, v);
+        }
+        if (selecionado)
+            selecao = glm::ivec3(x, y, z);
+    }
+
+    if (corrompido)
+    {
+        std::cerr << "Cor fora da paleta em " << nomeArquivo << "\n";
+        grade.redimensionar(tamanho);
+        return false;
+    }
+
+    informarProgresso(progresso, 1.0f);
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Formato binário
+
+template <typename T>
+void escreverBinario(std::vector<uint8_t> &buffer, T valor)
+{
+    size_t fim = buffer.size();
+    buffer.resize(fim + sizeof(T));
+    memcpy(&buffer[fim], &valor, sizeof(T));
+}
+
+// Codifica um chunk em corridas de voxels iguais
+inline void codificarChunk(const ChunkVoxel &c, std::vector<uint8_t> &buffer)
+{
+    escreverBinario<int32_t>(buffer, c.cx);
+    escreverBinario<int32_t>(buffer, c.cy);
+    escreverBinario<int32_t>(buffer, c.cz);
+
+    size_t posContagem = buffer.size();
+    escreverBinario<uint32_t>(buffer, 0);
+
+    // as corridas vazias saem inteiras do bitmap; nas visíveis só as cores são comparadas,
+    // até o próximo voxel vazio
+    uint32_t nCorridas = 0;
+    int i = 0;
+    while (i < VOXELS_POR_CHUNK)
+    {
+        int inicio = i;
+        uint8_t valor;
+        if (!c.ocupado(i))
+        {
+            valor = VAZIO_VOXB;
+            i = c.proximo(i);
+        }
+        else
+        {
+            valor = c.voxels[i].corPos;
+            int fimVisiveis = c.proximo(i, true);
+            while (i < fimVisiveis && c.voxels[i].corPos == valor)
+                i++;
+        }
+        escreverBinario<uint16_t>(buffer, (uint16_t)(i - inicio));
+        escreverBinario<uint8_t>(buffer, valor);
+        nCorridas++;
+    }
+    memcpy(&buffer[posContagem], &nCorridas, sizeof(uint32_t));
+}
+
+inline bool salvarGradeBinaria(const GradeVoxel &grade, const glm::vec4 *paleta, uint32_t nCores, const std::string &nomeArquivo,
+                               std::atomic<float> *progresso = nullptr)
+{
+    std::vector<uint8_t> buffer;
+    buffer.reserve(64 + nCores * sizeof(glm::vec4) + grade.chunks.size() * 256);
+
+    buffer.insert(buffer.end(), MAGICO_VOXB, MAGICO_VOXB + 4);
+    escreverBinario<uint16_t>(buffer, VERSAO_VOXB);
+    escreverBinario<uint16_t>(buffer, 0);
+    escreverBinario<int32_t>(buffer, grade.tam);
+    escreverBinario<uint32_t>(buffer, nCores);
+    escreverBinario<uint32_t>(buffer, (uint32_t)grade.chunks.size());
+    for (uint32_t i = 0; i < nCores; i++)
+        for (int k = 0; k < 4; k++)
+            escreverBinario<float>(buffer, paleta[i][k]);
+
+    size_t chunksGravados = 0;
+    for (const auto &par : grade.chunks)
+    {
+        codificarChunk(*par.second, buffer);
+        informarProgresso(progresso, 0.9f * ++chunksGravados / grade.chunks.size());
+    }
+
+    std::ofstream arquivo(nomeArquivo, std::ios::binary);
+    if (!arquivo.is_open())
+    {
+        std::cerr << "Erro ao abrir arquivo para escrita.\n";
+        return false;
+    }
+    arquivo.write((const char *)buffer.data(), buffer.size());
+    informarProgresso(progresso, 1.0f);
+    return (bool)arquivo;
+}
+
+// Arquivo inteiro mapeado em memória, somente leitura
+class ArquivoMapeado
+{
+public:
+    explicit ArquivoMapeado(const std::string &nomeArquivo)
+    {
+#ifdef _WIN32
+        arquivo = CreateFileA(nomeArquivo.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (arquivo == INVALID_HANDLE_VALUE)
+            return;
+        LARGE_INTEGER tamanhoArquivo;
+        if (!GetFileSizeEx(arquivo, &tamanhoArquivo) || tamanhoArquivo.QuadPart == 0)
+            return;
+        mapeamento = CreateFileMappingA(arquivo, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapeamento)
+            return;
+        dados = (const uint8_t *)MapViewOfFile(mapeamento, FILE_MAP_READ, 0, 0, 0);
+        if (dados)
+            tamanho = (size_t)tamanhoArquivo.QuadPart;
+#else
+        descritor = open(nomeArquivo.c_str(), O_RDONLY);
+        if (descritor < 0)
+            return;
+        struct stat info;
+        if (fstat(descritor, &info) != 0 || info.st_size == 0)
+            return;
+        void *p = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, descritor, 0);
+        if (p == MAP_FAILED)
+            return;
+        dados = (const uint8_t *)p;
+        tamanho = (size_t)info.st_size;
+#endif
+    }
+
+    ~ArquivoMapeado()
+    {
+#ifdef _WIN32
+        if (dados)
+            UnmapViewOfFile(dados);
+        if (mapeamento)
+            CloseHandle(mapeamento);
+        if (arquivo != INVALID_HANDLE_VALUE)
+            CloseHandle(arquivo);
+#else
+        if (dados)
+            munmap((void *)dados, tamanho);
+        if (descritor >= 0)
+            close(descritor);
+#endif
+    }
+
+    ArquivoMapeado(const ArquivoMapeado &) = delete;
+    ArquivoMapeado &operator=(const ArquivoMapeado &) = delete;
+
+    const uint8_t *dados = nullptr;
+    size_t tamanho = 0;
+
+private:
+#ifdef _WIN32
+    HANDLE arquivo = INVALID_HANDLE_VALUE;
+    HANDLE mapeamento = nullptr;
+#else
+    int descritor = -1;
+#endif
+};
+
+// Cursor de leitura sobre a memória mapeada; marca erro em vez de ler além do fim
+struct LeitorBinario
+{
+    const uint8_t *p, *fim;
+    bool ok = true;
+
+    template <typename T>
+    T ler()
+    {
+        T valor{};
+        if (fim - p < (ptrdiff_t)sizeof(T))
+        {
+            ok = false;
+            return valor;
+        }
+        memcpy(&valor, p, sizeof(T));
+        p += sizeof(T);
+        return valor;
+    }
+};
+
+// Carrega o formato binário direto da memória mapeada.
+// paleta (opcional) recebe as cores gravadas no arquivo, até CORES_EDITOR. Contagens que não
+// cabem no arquivo, chunks fora da grade e índices de cor fora da paleta rejeitam o arquivo.
+inline bool carregarGradeBinaria(GradeVoxel &grade, const std::string &nomeArquivo, std::vector<glm::vec4> *paleta = nullptr,
+                                 std::atomic<float> *progresso = nullptr)
+{
+    ArquivoMapeado arquivo(nomeArquivo);
+    if (!arquivo.dados)
+    {
+        std::cerr << "Erro ao abrir arquivo para leitura.\n";
+        return false;
+    }
+
+    LeitorBinario leitor{arquivo.dados, arquivo.dados + arquivo.tamanho};
+    if (arquivo.tamanho < 4 || memcmp(arquivo.dados, MAGICO_VOXB, 4) != 0)
+    {
+        std::cerr << "Arquivo de voxels inválido: " << nomeArquivo << "\n";
+        return false;
+    }
+    leitor.p += 4;
+
+    uint16_t versao = leitor.ler<uint16_t>();
+    leitor.ler<uint16_t>();
+    int32_t tam = leitor.ler<int32_t>();
+    uint32_t nCores = leitor.ler<uint32_t>();
+    uint32_t nChunks = leitor.ler<uint32_t>();
+    if (!leitor.ok || versao != VERSAO_VOXB || tam <= 0 || tam > (TAM_CHUNK << 21)) // limite de chaveChunk
+    {
+        std::cerr << "Versão ou cabeçalho não suportado: " << nomeArquivo << "\n";
+        return false;
+    }
+
+    // as contagens do cabeçalho só valem se couberem no resto do arquivo: cada cor ocupa 16 bytes
+    // e cada chunk pelo menos 19 (coordenadas, nCorridas e uma corrida)
+    size_t restante = (size_t)(leitor.fim - leitor.p);
+    if (nCores > MAX_CORES_VOXB || nCores > restante / 16 || nChunks > (restante - nCores * 16) / 19)
+    {
+        std::cerr << "Arquivo de voxels truncado ou corrompido: " << nomeArquivo << "\n";
+        return false;
+    }
+
+    std::vector<glm::vec4> cores(nCores);
+    for (uint32_t i = 0; i < nCores; i++)
+        for (int k = 0; k < 4; k++)
+            cores[i][k] = leitor.ler<float>();
+
+    // só as cores que o editor tem podem ser usadas pelos voxels
+    uint32_t coresUsaveis = std::min<uint32_t>(nCores, CORES_EDITOR);
+    int32_t chunksPorLado = (int32_t)(((int64_t)tam + TAM_CHUNK - 1) / TAM_CHUNK);
+
+    grade.redimensionar(tam);
+    grade.chunks.reserve(nChunks);
+    for (uint32_t n = 0; n < nChunks && leitor.ok; n++)
+    {
+        informarProgresso(progresso, (float)n / nChunks);
+
+        int32_t cx = leitor.ler<int32_t>();
+        int32_t cy = leitor.ler<int32_t>();
+        int32_t cz = leitor.ler<int32_t>();
+        uint32_t nCorridas = leitor.ler<uint32_t>();
+        if (!leitor.ok || cx < 0 || cy < 0 || cz < 0 || cx >= chunksPorLado || cy >= chunksPorLado ||
+            cz >= chunksPorLado)
+        {
+            leitor.ok = false;
+            break;
+        }
+
+        std::shared_ptr<ChunkVoxel> c = GradeVoxel::novoChunk(cx, cy, cz);
+
+        // as corridas são expandidas direto no chunk, sem passar por escrever()
+        int i = 0;
+        for (uint32_t r = 0; r < nCorridas; r++)
+        {
+            uint16_t comprimento = leitor.ler<uint16_t>();
+            uint8_t valor = leitor.ler<uint8_t>();
+            if (!leitor.ok || i + comprimento > VOXELS_POR_CHUNK || (valor != VAZIO_VOXB && valor >= coresUsaveis))
+            {
+                leitor.ok = false;
+                break;
+            }
+            if (valor != VAZIO_VOXB)
+            {
+                for (int k = i; k < i + comprimento; k++)
+                {
+                    c->voxels[k].corPos = valor;
+                    c->voxels[k].visivel = 1;
+                    c->marcar(k, true);
+                }
+                c->ocupados += comprimento;
+            }
+            i += comprimento;
+        }
+        if (i != VOXELS_POR_CHUNK) // as corridas cobrem o chunk inteiro
+            leitor.ok = false;
+
+        if (leitor.ok && c->ocupados > 0)
+            grade.chunks[GradeVoxel::chaveChunk(cx, cy, cz)] = std::move(c);
+    }
+
+    if (!leitor.ok)
+    {
+        std::cerr << "Arquivo de voxels truncado ou corrompido: " << nomeArquivo << "\n";
+        grade.redimensionar(tam);
+        return false;
+    }
+
+    if (paleta)
+        paleta->assign(cores.begin(), cores.begin() + coresUsaveis);
+    informarProgresso(progresso, 1.0f);
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Importação do formato .vox do MagicaVoxel (versão 150 e posteriores)
+//
+// O arquivo é uma árvore de chunks "id (4 bytes), bytes do conteúdo (i32), bytes dos filhos (i32)"
+// sob um chunk MAIN. Interessam SIZE (dimensões do modelo), XYZI (número de voxels e depois
+// x, y, z, índice de cor, um byte cada) e RGBA (256 cores; a cor i do arquivo é a entrada i - 1).
+// Os demais (PACK, nTRN, nGRP, nSHP, MATL, LAYR, rOBJ, ...) são pulados.
+
+// Paleta usada pelo MagicaVoxel quando o arquivo não tem chunk RGBA: o cubo 6×6×6 sem o preto,
+// seguido de rampas de 10 tons de vermelho, verde, azul e cinza
+inline void paletaPadraoVox(uint32_t rgba[256])
+{
+    const uint8_t cubo[6] = {0xFF, 0xCC, 0x99, 0x66, 0x33, 0x00};
+    const uint8_t rampa[10] = {0xEE, 0xDD, 0xBB, 0xAA, 0x88, 0x77, 0x55, 0x44, 0x22, 0x11};
+    int n = 0;
+    rgba[n++] = 0; // índice 0: vazio
+    for (int r = 0; r < 6; r++)
+        for (int g = 0; g < 6; g++)
+            for (int b = 0; b < 6; b++)
+                if (r < 5 || g < 5 || b < 5)
+                    rgba[n++] = 0xFF000000u | ((uint32_t)cubo[b] << 16) | ((uint32_t)cubo[g] << 8) | cubo[r];
+    for (int canal = 0; canal < 3; canal++)
+        for (int i = 0; i < 10; i++)
+            rgba[n++] = 0xFF000000u | ((uint32_t)rampa[i] << (8 * canal));
+    for (int i = 0; i < 10; i++)
+        rgba[n++] = 0xFF000000u | ((uint32_t)rampa[i] << 16) | ((uint32_t)rampa[i] << 8) | rampa[i];
+}
+
+// Carrega um .vox em uma só passada sobre a memória mapeada, escrevendo cada voxel direto no
+// seu chunk (o último chunk usado fica guardado, pois os voxels do XYZI costumam vir em ordem).
+// Enquanto lê, corPos guarda o índice de cor do arquivo; como o RGBA vem depois dos modelos, no
+// fim cada uma das 256 cores é trocada pela mais próxima da paleta do editor (nCores entradas)
+// e os chunks são percorridos uma vez para aplicar a tabela.
+// O eixo z do MagicaVoxel aponta para cima: (x, y, z) do arquivo vira (x, z, sy - 1 - y) na
+// grade, que mantém a orientação do modelo. Vários modelos são sobrepostos a partir da origem
+// (as transformações nTRN são ignoradas) e tam fica com a maior dimensão entre eles.
+inline bool carregarGradeVox(GradeVoxel &grade, const std::string &nomeArquivo, const glm::vec4 *paleta, int nCores,
+                             std::atomic<float> *progresso = nullptr)
+{
+    ArquivoMapeado arquivo(nomeArquivo);
+    if (!arquivo.dados)
+    {
+        std::cerr << "Erro ao abrir arquivo para leitura.\n";
+        return false;
+    }
+
+    LeitorBinario leitor{arquivo.dados, arquivo.dados + arquivo.tamanho};
+    if (arquivo.tamanho < 8 || memcmp(arquivo.dados, "VOX ", 4) != 0)
+    {
+        std::cerr << "Arquivo .vox inválido: " << nomeArquivo << "\n";
+        return false;
+    }
+    leitor.p += 8; // assinatura e versão
+
+    uint32_t rgba[256];
+    paletaPadraoVox(rgba);
+
+    grade.redimensionar(0);
+    int sx = 0, sy = 0, sz = 0, extensao = 0;
+    ChunkVoxel *atual = nullptr;
+    const float escalaProgresso = 1.0f / (float)arquivo.tamanho;
+
+    while (leitor.ok && leitor.p < leitor.fim)
+    {
+        char id[4];
+        for (int k = 0; k < 4; k++)
+            id[k] = (char)leitor.ler<uint8_t>();
+        int32_t bytesConteudo = leitor.ler<int32_t>();
+        int32_t bytesFilhos = leitor.ler<int32_t>();
+        if (!leitor.ok || bytesConteudo < 0 || bytesFilhos < 0 || leitor.fim - leitor.p < bytesConteudo)
+        {
+            leitor.ok = false;
+            break;
+        }
+        const uint8_t *fimConteudo = leitor.p + bytesConteudo;
+
+        // MAIN não tem conteúdo: os filhos são lidos em seguida, no mesmo laço
+        if (memcmp(id, "SIZE", 4) == 0)
+        {
+            sx = leitor.ler<int32_t>();
+            sy = leitor.ler<int32_t>();
+            sz = leitor.ler<int32_t>();
+            if (sx <= 0 || sy <= 0 || sz <= 0 || sx > 256 || sy > 256 || sz > 256)
+                leitor.ok = false;
+            extensao = std::max(extensao, std::max(sx, std::max(sy, sz)));
+        }
+        else if (memcmp(id, "XYZI", 4) == 0)
+        {
+            uint32_t n = leitor.ler<uint32_t>();
+            if (sx == 0 || n > (uint32_t)((fimConteudo - leitor.p) / 4))
+            {
+                leitor.ok = false;
+                break;
+            }
+            const uint8_t *v = leitor.p;
+            for (uint32_t i = 0; i < n; i++, v += 4)
+            {
+                if ((i & 0xFFFF) == 0)
+                    informarProgresso(progresso, (float)(v - arquivo.dados) * escalaProgresso);
+
+                int x = v[0], y = v[2], z = sy - 1 - v[1];
+                uint8_t cor = v[3];
+                if (cor == 0 || v[0] >= sx || v[1] >= sy || v[2] >= sz)
+                    continue;
+
+                int cx = x / TAM_CHUNK, cy = y / TAM_CHUNK, cz = z / TAM_CHUNK;
+                if (!atual || atual->cx != cx || atual->cy != cy || atual->cz != cz)
+                {
+                    std::shared_ptr<ChunkVoxel> &c = grade.chunks[GradeVoxel::chaveChunk(cx, cy, cz)];
+                    if (!c)
+                        c = GradeVoxel::novoChunk(cx, cy, cz);
+                    atual = c.get();
+                }
+
+                int local = GradeVoxel::indiceLocal(x % TAM_CHUNK, y % TAM_CHUNK, z % TAM_CHUNK);
+                Voxel &destino = atual->voxels[local];
+                atual->ocupados += !destino.visivel;
+                destino.corPos = cor;
+                destino.visivel = 1;
+                atual->marcar(local, true);
+            }
+        }
+        else if (memcmp(id, "RGBA", 4) == 0)
+        {
+            if (bytesConteudo < 256 * 4)
+            {
+                leitor.ok = false;
+                break;
+            }
+            for (int i = 0; i < 255; i++)
+                rgba[i + 1] = leitor.ler<uint32_t>();
+        }
+
+        leitor.p = fimConteudo;
+        if (memcmp(id, "MAIN", 4) != 0)
+        {
+            // nenhum chunk que lemos tem filhos; os dos outros são pulados junto com eles
+            if (leitor.fim - leitor.p < bytesFilhos)
+                leitor.ok = false;
+            else
+                leitor.p += bytesFilhos;
+        }
+    }
+
+    if (!leitor.ok || extensao == 0)
+    {
+        std::cerr << "Arquivo .vox truncado ou corrompido: " << nomeArquivo << "\n";
+        grade.redimensionar(0);
+        return false;
+    }
+
+    // cor do arquivo -> cor mais próxima da paleta do editor
+    uint8_t tabela[256];
+    for (int i = 0; i < 256; i++)
+    {
+        glm::vec4 cor((float)(rgba[i] & 0xFF), (float)((rgba[i] >> 8) & 0xFF), (float)((rgba[i] >> 16) & 0xFF),
+                      (float)(rgba[i] >> 24));
+        cor /= 255.0f;
+        float melhor = 1e30f;
+        tabela[i] = 0;
+        for (int k = 0; k < nCores; k++)
+        {
+            glm::vec4 d = paleta[k] - cor;
+            float distancia = glm::dot(d, d);
+            if (distancia < melhor)
+            {
+                melhor = distancia;
+                tabela[i] = (uint8_t)k;
+            }
+        }
+    }
+    for (auto &par : grade.chunks)
+    {
+        ChunkVoxel &c = *par.second;
+        GradeVoxel::paraCadaOcupado(c, [&](int local) { c.voxels[local].corPos = tabela[c.voxels[local].corPos]; });
+    }
+
+    grade.tam = extensao;
+    informarProgresso(progresso, 1.0f);
+    return true;
+}
@@ -0,0 +1,114 @@
+// Benchmark dos formatos de arquivo da grade: texto de sete campos contra o binário com RLE.
+// Gera um terreno em grades de tamanhos diferentes e mede tempo de gravação, de leitura
+// e tamanho do arquivo de cada formato.
+
+#include <iostream>
+#include <cstdio>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <fstream>
+#include <glm/glm.hpp>
+
+#include "GradeVoxel.h"
+#include "ArquivoVoxel.h"
+
+using namespace std;
+
+glm::vec4 paleta[10] = {
+    {0.5f, 0.5f, 0.5f, 0.5f}, {1.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f, 1.0f},
+    {1.0f, 1.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 1.0f, 1.0f}, {1.0f, 0.65f, 0.0f, 1.0f}, {0.6f, 0.4f, 0.2f, 1.0f},
+    {1.0f, 1.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 0.0f, 1.0f}};
+
+double agoraMs()
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+long long tamanhoArquivo(const string &nome)
+{
+    ifstream f(nome, ios::binary | ios::ate);
+    return f ? (long long)f.tellg() : -1;
+}
+
+size_t contarVoxels(const GradeVoxel &grade)
+{
+    size_t n = 0;
+    grade.paraCadaVoxel([&](int, int, int, const Voxel &) { n++; });
+    return n;
+}
+
+// Terreno ondulado com camadas de cor por altura e alguns blocos soltos no ar
+void gerarTerreno(GradeVoxel &grade, int tam)
+{
+    grade.redimensionar(tam);
+    mt19937 rng(7);
+    uniform_int_distribution<int> coord(0, tam - 1);
+    for (int x = 0; x < tam; x++)
+    {
+        for (int z = 0; z < tam; z++)
+        {
+            int altura = (int)(tam * (0.25f + 0.1f * sinf(x * 0.05f) + 0.1f * cosf(z * 0.07f)));
+            for (int y = 0; y < altura; y++)
+            {
+                Voxel v;
+                v.visivel = 1;
+                v.corPos = y < altura - 4 ? 7 : (y < altura - 1 ? 6 : 2); // marrom, laranja, verde
+                grade.escrever(x, y, z, v);
+            }
+        }
+    }
+    for (int i = 0; i < tam * 4; i++)
+    {
+        Voxel v;
+        v.visivel = 1;
+        v.corPos = (uint8_t)(1 + i % 9);
+        grade.escrever(coord(rng), coord(rng), coord(rng), v);
+    }
+}
+
+int main()
+{
+    const int tamanhos[] = {64, 128, 256};
+    const string arqTexto = "bench_grade.txt", arqBinario = "bench_grade.voxb";
+
+    printf("%5s | %10s | %-7s | %13s | %12s | %12s | %s\n", "TAM", "voxels", "formato", "arquivo (KB)", "gravar (ms)", "ler (ms)", "ok");
+    printf("------+------------+---------+---------------+--------------+--------------+----\n");
+
+    for (int tam : tamanhos)
+    {
+        GradeVoxel grade;
+        gerarTerreno(grade, tam);
+        size_t voxels = contarVoxels(grade);
+
+        // texto
+        double t0 = agoraMs();
+        salvarGradeTexto(grade, arqTexto, glm::ivec3(-1));
+        double gravarTexto = agoraMs() - t0;
+
+        GradeVoxel lidaTexto;
+        glm::ivec3 selecao(-1);
+        t0 = agoraMs();
+        carregarGradeTexto(lidaTexto, arqTexto, selecao);
+        double lerTexto = agoraMs() - t0;
+
+        // binário
+        t0 = agoraMs();
+        salvarGradeBinaria(grade, paleta, 10, arqBinario);
+        double gravarBinario = agoraMs() - t0;
+
+        GradeVoxel lidaBinario;
+        t0 = agoraMs();
+        carregarGradeBinaria(lidaBinario, arqBinario);
+        double lerBinario = agoraMs() - t0;
+
+        printf("%5d | %10zu | %-7s | %13.1f | %12.2f | %12.2f | %s\n", tam, voxels, "texto",
+               tamanhoArquivo(arqTexto) / 1024.0, gravarTexto, lerTexto, contarVoxels(lidaTexto) == voxels ? "sim" : "NAO");
+        printf("%5d | %10zu | %-7s | %13.1f | %12.2f | %12.2f | %s\n", tam, voxels, "binario",
+               tamanhoArquivo(arqBinario) / 1024.0, gravarBinario, lerBinario, contarVoxels(lidaBinario) == voxels ? "sim" : "NAO");
+    }
+
+    remove(arqTexto.c_str());
+    remove(arqBinario.c_str());
+    return 0;
+}
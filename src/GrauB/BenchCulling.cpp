@@ -0,0 +1,81 @@
+// Benchmark do culling em lote (FrustumLote.h): caixas do tamanho de um chunk espalhadas ao
+// redor da câmera, testadas contra o frustum de uma projeção perspectiva pelos caminhos
+// escalar, SSE e AVX2. Confere que os três devolvem a mesma lista e mede caixas por segundo.
+
+#include <iostream>
+#include <cstdio>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "GradeVoxel.h"
+#include "FrustumLote.h"
+
+using namespace std;
+
+double agoraMs()
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int main()
+{
+    const size_t quantidades[] = {1000, 10000, 100000, 1000000};
+    const size_t caixasPorMedida = 50000000; // cada medida testa cerca de 50 milhões de caixas
+
+    glm::mat4 proj = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 1500.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.3f, -0.2f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    Frustum frustum = extrairFrustum(proj * view);
+
+    CaminhoCulling caminhos[] = {CULLING_ESCALAR, CULLING_SSE, CULLING_AVX2};
+    CaminhoCulling melhor = melhorCaminhoCulling();
+    printf("Caminho escolhido neste processador: %s\n\n", NOMES_CAMINHO_CULLING[melhor]);
+    printf("%9s | %-8s | %10s | %16s | %9s\n", "caixas", "caminho", "ms/lote", "Mcaixas/s", "visíveis");
+    printf("----------+----------+------------+------------------+----------\n");
+
+    for (size_t n : quantidades)
+    {
+        // chunks (lado TAM_CHUNK) numa grade de 128 chunks de lado centrada na câmera
+        mt19937 rng(5);
+        uniform_int_distribution<int> coord(-64, 63);
+        CaixasSoA caixas;
+        for (size_t i = 0; i < n; i++)
+        {
+            glm::vec3 minimo((float)(coord(rng) * TAM_CHUNK), (float)(coord(rng) * TAM_CHUNK), (float)(coord(rng) * TAM_CHUNK));
+            caixas.adicionar(minimo, minimo + glm::vec3((float)TAM_CHUNK));
+        }
+
+        vector<uint32_t> referencia(n), visiveis(n);
+        size_t nReferencia = recortarCaixas(frustum, caixas, referencia.data(), CULLING_ESCALAR);
+        referencia.resize(nReferencia);
+
+        size_t repeticoes = max<size_t>(1, caixasPorMedida / n);
+        for (CaminhoCulling caminho : caminhos)
+        {
+#ifndef FRUSTUM_LOTE_X86
+            if (caminho != CULLING_ESCALAR)
+                continue;
+#endif
+            if (caminho == CULLING_AVX2 && melhor != CULLING_AVX2)
+            {
+                printf("%9zu | %-8s | %10s | %16s | %9s\n", n, NOMES_CAMINHO_CULLING[caminho], "-", "indisponível", "-");
+                continue;
+            }
+
+            size_t nVisiveis = recortarCaixas(frustum, caixas, visiveis.data(), caminho);
+            bool igual = nVisiveis == nReferencia && equal(referencia.begin(), referencia.end(), visiveis.begin());
+
+            double t0 = agoraMs();
+            size_t soma = 0;
+            for (size_t r = 0; r < repeticoes; r++)
+                soma += recortarCaixas(frustum, caixas, visiveis.data(), caminho);
+            double ms = agoraMs() - t0;
+
+            printf("%9zu | %-8s | %10.4f | %16.1f | %9zu%s\n", n, NOMES_CAMINHO_CULLING[caminho], ms / repeticoes,
+                   (double)n * repeticoes / ms / 1000.0, soma / repeticoes, igual ? "" : "  (DIFERENTE do escalar!)");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,224 @@
+// Benchmark da grade de voxels: compara o layout antigo (Voxel*** com posição e escala
+// guardadas em cada voxel) com a GradeVoxel esparsa, em chunks de 2 bytes por voxel.
+// Mede memória, tempo de alocação e o tempo de um laço igual ao de renderização.
+// Depois compara, na GradeVoxel, a varredura voxel a voxel pelo campo visivel com a varredura
+// pelo bitmap de ocupação dos chunks, para várias ocupações.
+
+#include <iostream>
+#include <cstdio>
+#include <chrono>
+#include <random>
+#include <glm/glm.hpp>
+
+#include "GradeVoxel.h"
+
+using namespace std;
+
+// Layout usado pelo editor antes da GradeVoxel
+struct VoxelAntigo
+{
+    glm::vec3 pos;
+    float fatorEscala;
+    bool visivel = true, selecionado = false;
+    int corPos;
+};
+
+double agoraMs()
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Resultado
+{
+    double memoriaMB, alocacaoMs, iteracaoMs;
+    size_t visiveis;
+};
+
+Resultado medirAntigo(int tam, float ocupacao)
+{
+    Resultado r;
+    double t0 = agoraMs();
+    VoxelAntigo ***grid = new VoxelAntigo **[tam];
+    for (int y = 0; y < tam; y++)
+    {
+        grid[y] = new VoxelAntigo *[tam];
+        for (int x = 0; x < tam; x++)
+            grid[y][x] = new VoxelAntigo[tam];
+    }
+    for (int y = 0; y < tam; y++)
+        for (int x = 0; x < tam; x++)
+            for (int z = 0; z < tam; z++)
+            {
+                VoxelAntigo &v = grid[y][x][z];
+                v.pos = glm::vec3(x - tam / 2, y - tam / 2, z - tam / 2);
+                v.fatorEscala = 0.98f;
+                v.visivel = false;
+                v.corPos = 0;
+            }
+    r.alocacaoMs = agoraMs() - t0;
+
+    mt19937 rng(42);
+    uniform_real_distribution<float> dist(0.0f, 1.0f);
+    for (int y = 0; y < tam; y++)
+        for (int x = 0; x < tam; x++)
+            for (int z = 0; z < tam; z++)
+                grid[y][x][z].visivel = dist(rng) < ocupacao;
+
+    // mesmo padrão de acesso do laço de renderização antigo: x, y, z sobre grid[y][x][z]
+    t0 = agoraMs();
+    glm::vec3 soma(0.0f);
+    size_t visiveis = 0;
+    for (int x = 0; x < tam; x++)
+        for (int y = 0; y < tam; y++)
+            for (int z = 0; z < tam; z++)
+            {
+                const VoxelAntigo &v = grid[y][x][z];
+                if (v.visivel || v.selecionado)
+                {
+                    soma += v.pos * v.fatorEscala;
+                    visiveis++;
+                }
+            }
+    r.iteracaoMs = agoraMs() - t0;
+    r.visiveis = visiveis + (soma.x == 1e30f); // impede que o laço seja descartado
+
+    r.memoriaMB = ((double)tam * tam * tam * sizeof(VoxelAntigo) + (double)tam * tam * sizeof(VoxelAntigo *) +
+                   (double)tam * sizeof(VoxelAntigo **)) / (1024.0 * 1024.0);
+
+    for (int y = 0; y < tam; y++)
+    {
+        for (int x = 0; x < tam; x++)
+            delete[] grid[y][x];
+        delete[] grid[y];
+    }
+    delete[] grid;
+    return r;
+}
+
+Resultado medirGradeVoxel(int tam, float ocupacao)
+{
+    Resultado r;
+    GradeVoxel grade;
+    double t0 = agoraMs();
+    grade.redimensionar(tam);
+    r.alocacaoMs = agoraMs() - t0;
+
+    mt19937 rng(42);
+    uniform_real_distribution<float> dist(0.0f, 1.0f);
+    for (int y = 0; y < tam; y++)
+        for (int x = 0; x < tam; x++)
+            for (int z = 0; z < tam; z++)
+            {
+                Voxel v;
+                v.visivel = dist(rng) < ocupacao;
+                grade.escrever(x, y, z, v);
+            }
+
+    t0 = agoraMs();
+    glm::vec3 soma(0.0f);
+    size_t visiveis = 0;
+    grade.paraCadaVoxel([&](int x, int y, int z, const Voxel &)
+    {
+        soma += grade.posicao(x, y, z) * FATOR_ESCALA_VOXEL;
+        visiveis++;
+    });
+    r.iteracaoMs = agoraMs() - t0;
+    r.visiveis = visiveis + (soma.x == 1e30f);
+
+    r.memoriaMB = grade.bytes() / (1024.0 * 1024.0);
+    return r;
+}
+
+struct ResultadoVarredura
+{
+    double porVoxelMs, bitmapMs, contarPorVoxelMs, contarBitmapMs;
+    size_t visiveis;
+};
+
+ResultadoVarredura medirVarredura(int tam, float ocupacao)
+{
+    GradeVoxel grade;
+    grade.redimensionar(tam);
+    mt19937 rng(7);
+    uniform_real_distribution<float> dist(0.0f, 1.0f);
+    for (int x = 0; x < tam; x++)
+        for (int y = 0; y < tam; y++)
+            for (int z = 0; z < tam; z++)
+                if (dist(rng) < ocupacao)
+                {
+                    Voxel v;
+                    v.visivel = 1;
+                    grade.escrever(x, y, z, v);
+                }
+
+    ResultadoVarredura r;
+    const int repeticoes = 10;
+    size_t soma = 0;
+
+    // o percurso de antes do bitmap: testa visivel em todos os voxels de cada chunk
+    double t0 = agoraMs();
+    for (int k = 0; k < repeticoes; k++)
+        for (const auto &par : grade.chunks)
+        {
+            const ChunkVoxel &c = *par.second;
+            for (int i = 0; i < VOXELS_POR_CHUNK; i++)
+                if (c.voxels[i].visivel)
+                    soma += i;
+        }
+    r.porVoxelMs = (agoraMs() - t0) / repeticoes;
+
+    t0 = agoraMs();
+    for (int k = 0; k < repeticoes; k++)
+        for (const auto &par : grade.chunks)
+            GradeVoxel::paraCadaOcupado(*par.second, [&](int i) { soma -= i; });
+    r.bitmapMs = (agoraMs() - t0) / repeticoes;
+
+    size_t contagem = 0;
+    t0 = agoraMs();
+    for (int k = 0; k < repeticoes; k++)
+        for (const auto &par : grade.chunks)
+            for (int i = 0; i < VOXELS_POR_CHUNK; i++)
+                contagem += par.second->voxels[i].visivel;
+    r.contarPorVoxelMs = (agoraMs() - t0) / repeticoes;
+
+    t0 = agoraMs();
+    for (int k = 0; k < repeticoes; k++)
+        contagem -= grade.contarOcupados();
+    r.contarBitmapMs = (agoraMs() - t0) / repeticoes;
+
+    // as duas varreduras e as duas contagens se anulam; diferente de zero indicaria erro
+    r.visiveis = grade.contarOcupados() + soma + contagem;
+    return r;
+}
+
+int main()
+{
+    const int tamanhos[] = {25, 128, 256};
+    const float ocupacao = 0.1f;
+
+    printf("Ocupação: %.0f%% dos voxels visíveis\n\n", ocupacao * 100.0f);
+    printf("%5s | %-10s | %12s | %12s | %12s | %10s\n", "TAM", "layout", "memória (MB)", "alocação (ms)", "iteração (ms)", "visíveis");
+    printf("------+------------+--------------+---------------+---------------+-----------\n");
+
+    for (int tam : tamanhos)
+    {
+        Resultado antigo = medirAntigo(tam, ocupacao);
+        Resultado novo = medirGradeVoxel(tam, ocupacao);
+        printf("%5d | %-10s | %12.2f | %13.2f | %13.2f | %10zu\n", tam, "Voxel***", antigo.memoriaMB, antigo.alocacaoMs, antigo.iteracaoMs, antigo.visiveis);
+        printf("%5d | %-10s | %12.2f | %13.2f | %13.2f | %10zu\n", tam, "GradeVoxel", novo.memoriaMB, novo.alocacaoMs, novo.iteracaoMs, novo.visiveis);
+    }
+
+    const float ocupacoes[] = {0.01f, 0.1f, 0.5f};
+    const int tamVarredura = 256;
+    printf("\nVarredura dos voxels visíveis, TAM %d (média de 10 repetições)\n\n", tamVarredura);
+    printf("%8s | %15s | %12s | %15s | %13s | %10s\n", "ocupação", "por voxel (ms)", "bitmap (ms)", "contar/voxel", "contar/bitmap", "visíveis");
+    printf("---------+-----------------+--------------+-----------------+---------------+-----------\n");
+    for (float o : ocupacoes)
+    {
+        ResultadoVarredura v = medirVarredura(tamVarredura, o);
+        printf("%7.0f%% | %15.2f | %12.2f | %15.2f | %13.3f | %10zu\n", o * 100.0f, v.porVoxelMs, v.bitmapMs,
+               v.contarPorVoxelMs, v.contarBitmapMs, v.visiveis);
+    }
+
+    return 0;
+}
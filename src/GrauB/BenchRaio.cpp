@@ -0,0 +1,99 @@
+// Benchmark do lançamento de raios na grade (percurso DDA de Amanatides e Woo).
+// Gera um terreno em uma grade 256³ e lança raios de pontos acima e ao redor dela em
+// direção a pontos aleatórios da grade, como faria o cursor do mouse no editor.
+
+#include <iostream>
+#include <cstdio>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "GradeVoxel.h"
+#include "RaioVoxel.h"
+
+using namespace std;
+
+double agoraMs()
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Terreno ondulado com camadas de cor por altura e alguns blocos soltos no ar
+void gerarTerreno(GradeVoxel &grade, int tam)
+{
+    grade.redimensionar(tam);
+    mt19937 rng(7);
+    uniform_int_distribution<int> coord(0, tam - 1);
+    for (int x = 0; x < tam; x++)
+    {
+        for (int z = 0; z < tam; z++)
+        {
+            int altura = (int)(tam * (0.25f + 0.1f * sinf(x * 0.05f) + 0.1f * cosf(z * 0.07f)));
+            for (int y = 0; y < altura; y++)
+            {
+                Voxel v;
+                v.visivel = 1;
+                v.corPos = y < altura - 4 ? 7 : (y < altura - 1 ? 6 : 2);
+                grade.escrever(x, y, z, v);
+            }
+        }
+    }
+    for (int i = 0; i < tam * 4; i++)
+    {
+        Voxel v;
+        v.visivel = 1;
+        v.corPos = (uint8_t)(1 + i % 9);
+        grade.escrever(coord(rng), coord(rng), coord(rng), v);
+    }
+}
+
+struct Raio
+{
+    glm::vec3 origem, direcao;
+};
+
+int main()
+{
+    const int TAM = 256;
+    const int N_RAIOS = 1000000;
+
+    GradeVoxel grade;
+    gerarTerreno(grade, TAM);
+
+    // origens numa esfera ao redor da grade (acima do terreno), alvos dentro dela
+    mt19937 rng(11);
+    uniform_real_distribution<float> u(-1.0f, 1.0f);
+    vector<Raio> raios(N_RAIOS);
+    for (Raio &r : raios)
+    {
+        glm::vec3 d(u(rng), fabsf(u(rng)) + 0.2f, u(rng));
+        r.origem = glm::normalize(d) * (1.2f * TAM);
+        glm::vec3 alvo(u(rng) * TAM / 2, u(rng) * TAM / 2, u(rng) * TAM / 2);
+        r.direcao = alvo - r.origem;
+    }
+
+    // aquece caches e preditores com os primeiros 1.000 raios antes de medir
+    AcertoVoxel acerto;
+    for (int i = 0; i < 1000; i++)
+        lancarRaio(grade, raios[i].origem, raios[i].direcao, 4.0f * TAM, acerto);
+
+    long long acertos = 0, celulas = 0;
+    double t0 = agoraMs();
+    for (const Raio &r : raios)
+    {
+        if (lancarRaio(grade, r.origem, r.direcao, 4.0f * TAM, acerto))
+        {
+            acertos++;
+            celulas += acerto.celulasVisitadas;
+        }
+    }
+    double ms = agoraMs() - t0;
+
+    printf("grade %d³, %zu chunks\n", TAM, grade.chunks.size());
+    printf("%d raios em %.1f ms: %.2f milhões de raios/s\n", N_RAIOS, ms, N_RAIOS / ms / 1000.0);
+    printf("%.1f%% acertaram, média de %.1f células visitadas por acerto\n",
+           100.0 * acertos / N_RAIOS, acertos ? (double)celulas / acertos : 0.0);
+    return 0;
+}
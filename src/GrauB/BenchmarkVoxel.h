@@ -0,0 +1,192 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <glm/glm.hpp>
+
+// Modo de benchmark do editor: carrega uma grade, percorre um caminho de câmera por N frames
+// sem vsync, em janela oculta, e imprime em JSON os percentis do tempo de frame e os draw calls
+// e triângulos por frame. Aqui ficam as partes sem OpenGL: opções da linha de comando, caminho
+// de câmera e o resumo das medidas.
+//
+//   GB --benchmark cena.voxb [--frames N] [--aquecimento N] [--modo imediato|instanciado|malha|octree]
+//                            [--caminho caminho.txt]
+//
+// Sem --caminho a câmera orbita o centro da grade, uma volta completa nos N frames.
+// Numa máquina sem GPU, o Mesa desenha por software (llvmpipe):
+//   LIBGL_ALWAYS_SOFTWARE=1 xvfb-run -a ./GB --benchmark cena.voxb
+
+struct OpcoesBenchmark
+{
+    bool ativo = false;
+    std::string arquivo;       // .voxb, texto se terminar em .txt ou MagicaVoxel se em .vox
+    std::string caminho;       // caminho gravado; vazio = órbita
+    std::string modo = "instanciado";
+    int frames = 600;
+    int aquecimento = 30;      // frames iniciais descartados (envio inicial dos dados, compilação)
+};
+
+// Devolve false (e explica em stderr) se a linha de comando estiver errada
+inline bool lerOpcoesBenchmark(int argc, char **argv, OpcoesBenchmark &opcoes)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool temValor = i + 1 < argc;
+        if (arg == "--benchmark")
+        {
+            opcoes.ativo = true;
+            if (temValor && argv[i + 1][0] != '-')
+                opcoes.arquivo = argv[++i];
+        }
+        else if (arg == "--frames" && temValor)
+            opcoes.frames = std::atoi(argv[++i]);
+        else if (arg == "--aquecimento" && temValor)
+            opcoes.aquecimento = std::atoi(argv[++i]);
+        else if (arg == "--modo" && temValor)
+            opcoes.modo = argv[++i];
+        else if (arg == "--caminho" && temValor)
+            opcoes.caminho = argv[++i];
+        else
+        {
+            std::cerr << "Opção desconhecida: " << arg << "\n";
+            return false;
+        }
+    }
+    if (opcoes.ativo && (opcoes.arquivo.empty() || opcoes.frames <= 0 || opcoes.aquecimento < 0))
+    {
+        std::cerr << "Uso: --benchmark arquivo [--frames N] [--aquecimento N] [--modo nome] [--caminho arquivo]\n";
+        return false;
+    }
+    return true;
+}
+
+// Uma posição do caminho de câmera; no arquivo, uma por linha: "px py pz fx fy fz fov"
+struct PoseCamera
+{
+    glm::vec3 posicao;
+    glm::vec3 frente;
+    float fov;
+};
+
+inline void gravarPose(std::ostream &saida, const PoseCamera &p)
+{
+    saida << p.posicao.x << ' ' << p.posicao.y << ' ' << p.posicao.z << ' '
+          << p.frente.x << ' ' << p.frente.y << ' ' << p.frente.z << ' ' << p.fov << '\n';
+}
+
+inline bool carregarCaminho(const std::string &nomeArquivo, std::vector<PoseCamera> &poses)
+{
+    std::ifstream entrada(nomeArquivo);
+    if (!entrada)
+        return false;
+    poses.clear();
+    std::string linha;
+    while (std::getline(entrada, linha))
+    {
+        std::istringstream campos(linha);
+        PoseCamera p;
+        if (campos >> p.posicao.x >> p.posicao.y >> p.posicao.z >> p.frente.x >> p.frente.y >> p.frente.z >> p.fov)
+            poses.push_back(p);
+    }
+    return !poses.empty();
+}
+
+// Órbita em torno do centro da grade (a origem do mundo), um pouco acima, olhando para o centro
+inline PoseCamera poseOrbita(int frame, int totalFrames, int tam)
+{
+    float angulo = 6.2831853f * (float)frame / (float)totalFrames;
+    float raio = 0.75f * (float)tam;
+    PoseCamera p;
+    p.posicao = glm::vec3(raio * std::cos(angulo), 0.35f * (float)tam, raio * std::sin(angulo));
+    p.frente = glm::normalize(-p.posicao);
+    p.fov = 45.0f;
+    return p;
+}
+
+// Resumo de uma série de medidas: percentis pelo posto mais próximo
+struct ResumoMedidas
+{
+    double media = 0.0, p50 = 0.0, p95 = 0.0, p99 = 0.0, maximo = 0.0;
+};
+
+inline ResumoMedidas resumir(std::vector<double> valores)
+{
+    ResumoMedidas r;
+    if (valores.empty())
+        return r;
+    std::sort(valores.begin(), valores.end());
+    size_t n = valores.size();
+    auto percentil = [&](double p)
+    {
+        size_t posto = (size_t)std::ceil(p / 100.0 * (double)n);
+        return valores[std::min(std::max(posto, (size_t)1), n) - 1];
+    };
+    double soma = 0.0;
+    for (double v : valores)
+        soma += v;
+    r.media = soma / (double)n;
+    r.p50 = percentil(50.0);
+    r.p95 = percentil(95.0);
+    r.p99 = percentil(99.0);
+    r.maximo = valores.back();
+    return r;
+}
+
+// Medidas por frame coletadas pelo laço do benchmark
+struct MedidasBenchmark
+{
+    std::vector<double> tempoFrameMs, tempoCPUMs, drawCalls, triangulos, bytesEnviados;
+    std::vector<double> filaMalhas; // trabalhos de malha ainda não enviados à GPU no fim do frame
+};
+
+inline std::string textoJSON(const std::string &s)
+{
+    std::string r = "\"";
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\')
+            r += '\\';
+        if ((unsigned char)c < 0x20)
+            continue;
+        r += c;
+    }
+    return r + "\"";
+}
+
+inline void imprimirResumoJSON(std::ostream &saida, const char *nome, const ResumoMedidas &r, bool ultimo = false)
+{
+    char texto[256];
+    std::snprintf(texto, sizeof(texto), "  \"%s\": {\"media\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f}%s\n",
+                  nome, r.media, r.p50, r.p95, r.p99, r.maximo, ultimo ? "" : ",");
+    saida << texto;
+}
+
+inline void imprimirBenchmarkJSON(std::ostream &saida, const OpcoesBenchmark &opcoes, const std::string &renderer,
+                                  int tam, size_t voxels, const MedidasBenchmark &m)
+{
+    saida << "{\n";
+    saida << "  \"arquivo\": " << textoJSON(opcoes.arquivo) << ",\n";
+    saida << "  \"caminho\": " << textoJSON(opcoes.caminho.empty() ? "orbita" : opcoes.caminho) << ",\n";
+    saida << "  \"modo\": " << textoJSON(opcoes.modo) << ",\n";
+    saida << "  \"renderer\": " << textoJSON(renderer) << ",\n";
+    saida << "  \"tam\": " << tam << ",\n";
+    saida << "  \"voxels\": " << voxels << ",\n";
+    saida << "  \"frames\": " << m.tempoFrameMs.size() << ",\n";
+    saida << "  \"aquecimento\": " << opcoes.aquecimento << ",\n";
+    imprimirResumoJSON(saida, "frameMs", resumir(m.tempoFrameMs));
+    imprimirResumoJSON(saida, "cpuMs", resumir(m.tempoCPUMs));
+    imprimirResumoJSON(saida, "drawCalls", resumir(m.drawCalls));
+    imprimirResumoJSON(saida, "triangulos", resumir(m.triangulos));
+    imprimirResumoJSON(saida, "bytesEnviados", resumir(m.bytesEnviados));
+    imprimirResumoJSON(saida, "filaMalhas", resumir(m.filaMalhas), true);
+    saida << "}\n";
+}
@@ -0,0 +1,474 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <glm/glm.hpp>
+
+#include "GradeVoxel.h"
+#include "MalhaVoxel.h"
+#include "ArquivoVoxel.h"
+
+// Exportação da grade como malha, em OBJ (com .mtl) ou em glTF binário (.glb).
+// A malha é gerada chunk a chunk pelo mesmo gerador do modo malha (só as faces que encostam no
+// vazio, unidas ou não pelo modo guloso) e escrita assim que fica pronta: em memória só ficam a
+// malha de um chunk e os buffers de escrita, qualquer que seja o tamanho da grade.
+// Dentro de cada chunk os vértices repetidos são unidos e os triângulos agrupados pela cor da
+// paleta, que vira o material.
+
+// Escrita bufferizada em um FILE*; grava em blocos de tamanho fixo
+class EscritorBuffer
+{
+public:
+    explicit EscritorBuffer(FILE *arquivo, size_t capacidade = 1 << 16) : arquivo(arquivo)
+    {
+        buffer.reserve(capacidade);
+    }
+
+    ~EscritorBuffer() { descarregar(); }
+
+    EscritorBuffer(const EscritorBuffer &) = delete;
+    EscritorBuffer &operator=(const EscritorBuffer &) = delete;
+
+    void escrever(const void *dados, size_t n)
+    {
+        if (buffer.size() + n > buffer.capacity())
+            descarregar();
+        if (n >= buffer.capacity())
+            ok = std::fwrite(dados, 1, n, arquivo) == n && ok;
+        else
+            buffer.insert(buffer.end(), (const char *)dados, (const char *)dados + n);
+    }
+
+    void texto(const char *s) { escrever(s, std::strlen(s)); }
+
+    // Inteiro sem sinal, sem passar por printf: os índices das faces são a maior parte de um OBJ
+    void inteiro(uint64_t v)
+    {
+        char digitos[20];
+        int n = 0;
+        do
+        {
+            digitos[n++] = (char)('0' + v % 10);
+            v /= 10;
+        } while (v);
+        char s[20];
+        for (int i = 0; i < n; i++)
+            s[i] = digitos[n - 1 - i];
+        escrever(s, n);
+    }
+
+    void real(float v)
+    {
+        char s[32];
+        int n = std::snprintf(s, sizeof(s), "%.9g", v);
+        escrever(s, (size_t)n);
+    }
+
+    void descarregar()
+    {
+        if (!buffer.empty())
+            ok = std::fwrite(buffer.data(), 1, buffer.size(), arquivo) == buffer.size() && ok;
+        buffer.clear();
+    }
+
+    bool ok = true;
+
+private:
+    FILE *arquivo;
+    std::vector<char> buffer;
+};
+
+// Malha de um chunk pronta para escrever: vértices sem repetição, em coordenadas de mundo, e os
+// triângulos (três índices locais cada) ordenados pela cor, com a faixa de cada cor
+struct MalhaChunkExportada
+{
+    std::vector<glm::vec3> posicoes;
+    std::vector<uint32_t> indices;
+    std::vector<uint8_t> normais; // uma por triângulo: 0..5 = -x, +x, -y, +y, -z, +z
+    uint32_t inicioCor[257];      // triângulos da cor k em [inicioCor[k], inicioCor[k + 1])
+};
+
+// Gera a malha do chunk e une os vértices repetidos. Os vértices de um chunk só podem cair nos
+// cantos inteiros de 0 a TAM_CHUNK, então a busca é uma tabela (TAM_CHUNK + 1)³ em vez de hash;
+// marca evita limpar a tabela a cada chunk.
+class MalhadorExportacao
+{
+public:
+    MalhadorExportacao(const GradeVoxel &grade, glm::vec3 origem, bool guloso, uint32_t mascaraTranslucidas)
+        : grade(grade), origem(origem), guloso(guloso), mascaraTranslucidas(mascaraTranslucidas),
+          vizinhanca(new VizinhancaChunk()), indiceCanto(LADO * LADO * LADO), marcaCanto(LADO * LADO * LADO, 0)
+    {
+    }
+
+    void gerar(const ChunkVoxel &c, MalhaChunkExportada &saida)
+    {
+        capturarVizinhanca(grade, c, *vizinhanca);
+        const VizinhancaChunk &v = *vizinhanca;
+        gerarMalhaChunk([&v](int x, int y, int z) { return v.corEm(x, y, z); },
+                        c.cx, c.cy, c.cz, grade.tam, glm::vec3(0.0f), guloso, mascaraTranslucidas, triangulos);
+
+        // ordenação por contagem dos triângulos pela cor
+        size_t nTriangulos = triangulos.size() / 3;
+        uint32_t contagem[257] = {};
+        for (size_t t = 0; t < nTriangulos; t++)
+            contagem[triangulos[3 * t].cor + 1]++;
+        for (int k = 0; k < 256; k++)
+            contagem[k + 1] += contagem[k];
+        std::copy(contagem, contagem + 257, saida.inicioCor);
+        ordem.resize(nTriangulos);
+        for (size_t t = 0; t < nTriangulos; t++)
+            ordem[contagem[triangulos[3 * t].cor]++] = (uint32_t)t;
+
+        marca++;
+        glm::ivec3 base(c.cx * TAM_CHUNK, c.cy * TAM_CHUNK, c.cz * TAM_CHUNK);
+        saida.posicoes.clear();
+        saida.indices.resize(3 * nTriangulos);
+        saida.normais.resize(nTriangulos);
+        for (size_t i = 0; i < nTriangulos; i++)
+        {
+            const VerticeMalha *tri = &triangulos[3 * ordem[i]];
+            for (int k = 0; k < 3; k++)
+            {
+                glm::ivec3 l = glm::ivec3(tri[k].pos) - base;
+                int chave = (l.x * LADO + l.y) * LADO + l.z;
+                if (marcaCanto[chave] != marca)
+                {
+                    marcaCanto[chave] = marca;
+                    indiceCanto[chave] = (uint32_t)saida.posicoes.size();
+                    saida.posicoes.push_back(tri[k].pos + origem);
+                }
+                saida.indices[3 * i + k] = indiceCanto[chave];
+            }
+
+            // os triângulos são alinhados aos eixos: a normal é o eixo de maior componente
+            glm::vec3 n = glm::cross(tri[1].pos - tri[0].pos, tri[2].pos - tri[0].pos);
+            glm::vec3 a = glm::abs(n);
+            int d = a.x >= a.y && a.x >= a.z ? 0 : (a.y >= a.z ? 1 : 2);
+            saida.normais[i] = (uint8_t)(2 * d + (n[d] > 0.0f ? 1 : 0));
+        }
+    }
+
+private:
+    static const int LADO = TAM_CHUNK + 1;
+
+    const GradeVoxel &grade;
+    glm::vec3 origem;
+    bool guloso;
+    uint32_t mascaraTranslucidas;
+    std::unique_ptr<VizinhancaChunk> vizinhanca;
+    std::vector<VerticeMalha> triangulos;
+    std::vector<uint32_t> ordem;
+    std::vector<uint32_t> indiceCanto;
+    std::vector<uint32_t> marcaCanto;
+    uint32_t marca = 0;
+};
+
+// Índices de cor translúcidos (alfa < 1) não escondem as faces dos vizinhos
+inline uint32_t mascaraTranslucidasPaleta(const glm::vec4 *paleta, int nCores)
+{
+    uint32_t mascara = 0;
+    for (int i = 0; i < nCores && i < 32; i++)
+        if (paleta[i].a < 1.0f)
+            mascara |= 1u << i;
+    return mascara;
+}
+
+// O voxel de índice i fica centrado em i - tam / 2, como no editor
+inline glm::vec3 origemExportacao(int tam)
+{
+    return glm::vec3(-(float)(tam / 2) - 0.5f);
+}
+
+// ---------------------------------------------------------------------------------------------
+// OBJ: os vértices de cada chunk e, em seguida, suas faces, um "usemtl corK" por cor presente.
+// As seis normais são escritas uma vez no início. O .mtl vai ao lado, com o mesmo nome.
+
+inline bool exportarMalhaOBJ(const GradeVoxel &grade, const glm::vec4 *paleta, int nCores, bool guloso,
+                             const std::string &nomeArquivo, std::atomic<float> *progresso = nullptr)
+{
+    std::string nomeMTL = nomeArquivo.substr(0, nomeArquivo.find_last_of('.')) + ".mtl";
+    size_t barra = nomeMTL.find_last_of("/\\");
+    std::string referenciaMTL = barra == std::string::npos ? nomeMTL : nomeMTL.substr(barra + 1);
+
+    FILE *arquivoMTL = std::fopen(nomeMTL.c_str(), "wb");
+    if (!arquivoMTL)
+    {
+        std::cerr << "Erro ao abrir arquivo para escrita.\n";
+        return false;
+    }
+    for (int k = 0; k < nCores; k++)
+        std::fprintf(arquivoMTL, "newmtl cor%d\nKd %.6g %.6g %.6g\nd %.6g\n\n", k, paleta[k].r, paleta[k].g, paleta[k].b, paleta[k].a);
+    bool ok = std::fclose(arquivoMTL) == 0;
+
+    FILE *arquivo = std::fopen(nomeArquivo.c_str(), "wb");
+    if (!arquivo)
+    {
+        std::cerr << "Erro ao abrir arquivo para escrita.\n";
+        return false;
+    }
+
+    {
+        EscritorBuffer saida(arquivo, 1 << 20);
+        saida.texto("# grade de voxels exportada como malha\nmtllib ");
+        saida.texto(referenciaMTL.c_str());
+        saida.texto("\nvn -1 0 0\nvn 1 0 0\nvn 0 -1 0\nvn 0 1 0\nvn 0 0 -1\nvn 0 0 1\n");
+
+        MalhadorExportacao malhador(grade, origemExportacao(grade.tam), guloso, mascaraTranslucidasPaleta(paleta, nCores));
+        MalhaChunkExportada malha;
+        uint64_t primeiro = 1; // índices do OBJ começam em 1 e são globais
+        size_t n = 0;
+        for (const auto &par : grade.chunks)
+        {
+            informarProgresso(progresso, (float)n++ / grade.chunks.size());
+            malhador.gerar(*par.second, malha);
+
+            for (const glm::vec3 &p : malha.posicoes)
+            {
+                saida.texto("v ");
+                saida.real(p.x);
+                saida.texto(" ");
+                saida.real(p.y);
+                saida.texto(" ");
+                saida.real(p.z);
+                saida.texto("\n");
+            }
+            for (int k = 0; k < 256; k++)
+            {
+                if (malha.inicioCor[k] == malha.inicioCor[k + 1])
+                    continue;
+                saida.texto("usemtl cor");
+                saida.inteiro((uint64_t)k);
+                saida.texto("\n");
+                for (uint32_t t = malha.inicioCor[k]; t < malha.inicioCor[k + 1]; t++)
+                {
+                    saida.texto("f");
+                    for (int v = 0; v < 3; v++)
+                    {
+                        saida.texto(" ");
+                        saida.inteiro(primeiro + malha.indices[3 * t + v]);
+                        saida.texto("//");
+                        saida.inteiro((uint64_t)malha.normais[t] + 1);
+                    }
+                    saida.texto("\n");
+                }
+            }
+            primeiro += malha.posicoes.size();
+        }
+        saida.descarregar();
+        ok = ok && saida.ok;
+    }
+
+    ok = std::fclose(arquivo) == 0 && ok;
+    if (!ok)
+        std::cerr << "Erro ao gravar " << nomeArquivo << "\n";
+    informarProgresso(progresso, 1.0f);
+    return ok;
+}
+
+// ---------------------------------------------------------------------------------------------
+// glTF binário: uma malha com uma primitiva por cor da paleta, todas sobre o mesmo buffer de
+// posições. O .glb começa pelo JSON, que depende das contagens finais; por isso o espaço do JSON
+// é reservado no início (com o tamanho que ele teria com os maiores números possíveis), as
+// posições são escritas logo depois, conforme saem dos chunks, e os índices de cada cor vão para
+// um arquivo temporário próprio, copiado para o fim do .glb ao terminar. No fim o JSON real é
+// gravado no espaço reservado, completado com espaços, como o formato permite.
+
+struct ContagemGLB
+{
+    uint64_t vertices = 0;
+    uint64_t indices[256] = {};
+    glm::vec3 minimo = glm::vec3(0.0f), maximo = glm::vec3(0.0f);
+};
+
+inline std::string jsonGLB(const ContagemGLB &c, const glm::vec4 *paleta, int nCores)
+{
+    char t[512];
+    std::string primitivasJSON, materiais, views, acessores;
+
+    uint64_t offset = c.vertices * 12;
+    std::snprintf(t, sizeof(t), "{\"buffer\":0,\"byteOffset\":0,\"byteLength\":%llu,\"target\":34962}",
+                  (unsigned long long)(c.vertices * 12));
+    views = t;
+    std::snprintf(t, sizeof(t), "{\"bufferView\":0,\"componentType\":5126,\"count\":%llu,\"type\":\"VEC3\","
+                                "\"min\":[%.9g,%.9g,%.9g],\"max\":[%.9g,%.9g,%.9g]}",
+                  (unsigned long long)c.vertices, c.minimo.x, c.minimo.y, c.minimo.z, c.maximo.x, c.maximo.y, c.maximo.z);
+    acessores = t;
+
+    int primitivas = 0;
+    for (int k = 0; k < nCores; k++)
+    {
+        if (c.indices[k] == 0)
+            continue;
+        std::snprintf(t, sizeof(t), "%s{\"attributes\":{\"POSITION\":0},\"indices\":%d,\"material\":%d}",
+                      primitivas ? "," : "", primitivas + 1, k);
+        primitivasJSON += t;
+        std::snprintf(t, sizeof(t), ",{\"buffer\":0,\"byteOffset\":%llu,\"byteLength\":%llu,\"target\":34963}",
+                      (unsigned long long)offset, (unsigned long long)(c.indices[k] * 4));
+        views += t;
+        std::snprintf(t, sizeof(t), ",{\"bufferView\":%d,\"componentType\":5125,\"count\":%llu,\"type\":\"SCALAR\"}",
+                      primitivas + 1, (unsigned long long)c.indices[k]);
+        acessores += t;
+        offset += c.indices[k] * 4;
+        primitivas++;
+    }
+    for (int k = 0; k < nCores; k++)
+    {
+        std::snprintf(t, sizeof(t), "%s{\"name\":\"cor%d\",\"pbrMetallicRoughness\":{\"baseColorFactor\":[%.6g,%.6g,%.6g,%.6g],"
+                                    "\"metallicFactor\":0,\"roughnessFactor\":1}%s}",
+                      k ? "," : "", k, paleta[k].r, paleta[k].g, paleta[k].b, paleta[k].a,
+                      paleta[k].a < 1.0f ? ",\"alphaMode\":\"BLEND\"" : "");
+        materiais += t;
+    }
+
+    // uma malha precisa de ao menos uma primitiva: sem faces a cena fica vazia
+    std::string json = "{\"asset\":{\"version\":\"2.0\",\"generator\":\"GB\"},\"scene\":0,";
+    if (primitivas == 0)
+        json += "\"scenes\":[{}]";
+    else
+        json += "\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0}],\"meshes\":[{\"primitives\":[" + primitivasJSON + "]}]";
+    json += ",\"materials\":[" + materiais + "]";
+    if (c.vertices > 0)
+    {
+        std::snprintf(t, sizeof(t), ",\"buffers\":[{\"byteLength\":%llu}]", (unsigned long long)offset);
+        json += t;
+        json += ",\"bufferViews\":[" + views + "],\"accessors\":[" + acessores + "]";
+    }
+    return json + "}";
+}
+
+inline bool exportarMalhaGLB(const GradeVoxel &grade, const glm::vec4 *paleta, int nCores, bool guloso,
+                             const std::string &nomeArquivo, std::atomic<float> *progresso = nullptr)
+{
+    nCores = std::min(nCores, 256);
+
+    // o maior JSON possível: todas as cores em uso e os números com o maior número de dígitos
+    // (o .glb inteiro tem no máximo 4 GB, então nenhuma contagem passa de 32 bits)
+    ContagemGLB maior;
+    maior.vertices = UINT32_MAX;
+    for (int k = 0; k < nCores; k++)
+        maior.indices[k] = UINT32_MAX;
+    maior.minimo = maior.maximo = glm::vec3(-1.23456789e+30f);
+    size_t reservaJSON = (jsonGLB(maior, paleta, nCores).size() + 3) & ~(size_t)3;
+
+    FILE *arquivo = std::fopen(nomeArquivo.c_str(), "wb");
+    if (!arquivo)
+    {
+        std::cerr << "Erro ao abrir arquivo para escrita.\n";
+        return false;
+    }
+
+    bool vazia = grade.chunks.empty();
+    std::vector<FILE *> temporarios(nCores, nullptr);
+    std::vector<std::unique_ptr<EscritorBuffer>> escritoresIndices(nCores);
+    ContagemGLB contagem;
+    bool ok = true;
+
+    {
+        // cabeçalho (12), cabeçalho do JSON (8), JSON reservado e cabeçalho do BIN (8), gravados no fim;
+        // uma grade sem chunks não tem faces, e o arquivo fica sem o BIN
+        std::vector<char> vazio(12 + 8 + reservaJSON + (vazia ? 0 : 8), ' ');
+        ok = std::fwrite(vazio.data(), 1, vazio.size(), arquivo) == vazio.size();
+
+        EscritorBuffer posicoes(arquivo, 1 << 20);
+        MalhadorExportacao malhador(grade, origemExportacao(grade.tam), guloso, mascaraTranslucidasPaleta(paleta, nCores));
+        MalhaChunkExportada malha;
+        size_t n = 0;
+        for (const auto &par : grade.chunks)
+        {
+            informarProgresso(progresso, 0.9f * (float)n++ / grade.chunks.size());
+            malhador.gerar(*par.second, malha);
+
+            for (const glm::vec3 &p : malha.posicoes)
+            {
+                if (contagem.vertices == 0)
+                    contagem.minimo = contagem.maximo = p;
+                contagem.minimo = glm::min(contagem.minimo, p);
+                contagem.maximo = glm::max(contagem.maximo, p);
+                posicoes.escrever(&p, sizeof(glm::vec3));
+                contagem.vertices++;
+            }
+
+            // os índices de cada cor são globais: somados ao primeiro vértice do chunk
+            uint32_t primeiro = (uint32_t)(contagem.vertices - malha.posicoes.size());
+            for (int k = 0; k < nCores; k++)
+            {
+                if (malha.inicioCor[k] == malha.inicioCor[k + 1])
+                    continue;
+                if (!escritoresIndices[k])
+                {
+                    temporarios[k] = std::tmpfile();
+                    if (!temporarios[k])
+                    {
+                        ok = false;
+                        break;
+                    }
+                    escritoresIndices[k].reset(new EscritorBuffer(temporarios[k]));
+                }
+                for (uint32_t i = 3 * malha.inicioCor[k]; i < 3 * malha.inicioCor[k + 1]; i++)
+                {
+                    uint32_t indice = primeiro + malha.indices[i];
+                    escritoresIndices[k]->escrever(&indice, 4);
+                }
+                contagem.indices[k] += 3 * (malha.inicioCor[k + 1] - malha.inicioCor[k]);
+            }
+            // os índices do glTF são de 32 bits
+            if (!ok || contagem.vertices > UINT32_MAX)
+            {
+                ok = false;
+                break;
+            }
+        }
+        posicoes.descarregar();
+        ok = ok && posicoes.ok;
+    }
+
+    // copia os índices de cada cor para o fim do arquivo, na ordem das primitivas
+    std::vector<char> bloco(1 << 20);
+    for (int k = 0; k < nCores; k++)
+    {
+        if (!temporarios[k])
+            continue;
+        escritoresIndices[k]->descarregar();
+        ok = ok && escritoresIndices[k]->ok;
+        std::rewind(temporarios[k]);
+        size_t lidos;
+        while (ok && (lidos = std::fread(bloco.data(), 1, bloco.size(), temporarios[k])) > 0)
+            ok = std::fwrite(bloco.data(), 1, lidos, arquivo) == lidos;
+        escritoresIndices[k].reset();
+        std::fclose(temporarios[k]);
+    }
+    informarProgresso(progresso, 0.95f);
+
+    uint64_t bytesBIN = contagem.vertices * 12;
+    for (int k = 0; k < nCores; k++)
+        bytesBIN += contagem.indices[k] * 4;
+    uint64_t total = 12 + 8 + reservaJSON + (vazia ? 0 : 8 + bytesBIN);
+    if (ok && total > UINT32_MAX)
+        ok = false;
+
+    if (ok)
+    {
+        std::string json = jsonGLB(contagem, paleta, nCores);
+        json.resize(reservaJSON, ' ');
+        uint32_t cabecalho[5] = {0x46546C67u /* "glTF" */, 2, (uint32_t)total, (uint32_t)reservaJSON, 0x4E4F534Au /* "JSON" */};
+        uint32_t cabecalhoBIN[2] = {(uint32_t)bytesBIN, 0x004E4942u /* "BIN\0" */};
+        ok = std::fseek(arquivo, 0, SEEK_SET) == 0 &&
+             std::fwrite(cabecalho, 1, sizeof(cabecalho), arquivo) == sizeof(cabecalho) &&
+             std::fwrite(json.data(), 1, json.size(), arquivo) == json.size();
+        if (ok && !vazia)
+            ok = std::fwrite(cabecalhoBIN, 1, sizeof(cabecalhoBIN), arquivo) == sizeof(cabecalhoBIN);
+    }
+    ok = std::fclose(arquivo) == 0 && ok;
+
+    if (!ok)
+        std::cerr << "Erro ao gravar " << nomeArquivo << "\n";
+    informarProgresso(progresso, 1.0f);
+    return ok;
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <glm/glm.hpp>
+
+#include "GradeVoxel.h"
+#include "MalhaVoxel.h"
+#include "PoolThreads.h"
+
+// Fila de geração de malhas de chunk nas threads do pool.
+// A thread de render captura a vizinhança do chunk (cópia imutável) e envia o trabalho; as
+// threads de trabalho pegam sempre o pendente mais próximo da câmera, geram a malha e a
+// deixam na lista de prontas, de onde a thread de render tira um número limitado por frame
+// para enviar à GPU. Nada aqui chama OpenGL.
+
+struct TrabalhoMalha
+{
+    uint64_t chave;
+    uint32_t geracao;  // descarta resultados de uma grade que já foi trocada
+    glm::vec3 centro;  // centro do chunk em coordenadas de mundo, para a prioridade
+    float distancia2 = 0.0f;
+    std::unique_ptr<VizinhancaChunk> vizinhanca;
+    int tam;
+    glm::vec3 origem;
+    bool guloso;
+    uint32_t mascaraTranslucidas;
+};
+
+struct MalhaPronta
+{
+    uint64_t chave;
+    uint32_t geracao;
+    std::vector<VerticeMalha> vertices;
+};
+
+class FilaMalhas
+{
+public:
+    explicit FilaMalhas(PoolThreads &pool) : pool(pool), estado(std::make_shared<Estado>()) {}
+
+    // Atualiza a posição da câmera e reordena os pendentes pela nova distância
+    void definirCamera(glm::vec3 posicao)
+    {
+        std::lock_guard<std::mutex> trava(estado->mutex);
+        if (posicao == estado->camera)
+            return;
+        estado->camera = posicao;
+        for (TrabalhoMalha &t : estado->pendentes)
+            t.distancia2 = distancia2(t.centro, posicao);
+        std::make_heap(estado->pendentes.begin(), estado->pendentes.end(), maisLonge);
+    }
+
+    void enviar(TrabalhoMalha trabalho)
+    {
+        {
+            std::lock_guard<std::mutex> trava(estado->mutex);
+            trabalho.distancia2 = distancia2(trabalho.centro, estado->camera);
+            estado->pendentes.push_back(std::move(trabalho));
+            std::push_heap(estado->pendentes.begin(), estado->pendentes.end(), maisLonge);
+        }
+
+        // cada tarefa do pool gera uma malha, mas escolhe qual só na hora de rodar;
+        // o estado é compartilhado para que tarefas atrasadas sobrevivam à fila
+        std::shared_ptr<Estado> e = estado;
+        pool.enfileirar([e]() { executarProximo(*e); });
+    }
+
+    // Move para saida até limite malhas prontas; devolve quantas foram movidas
+    size_t receber(size_t limite, std::vector<MalhaPronta> &saida)
+    {
+        std::lock_guard<std::mutex> trava(estado->mutex);
+        size_t n = std::min(limite, estado->prontas.size());
+        for (size_t i = 0; i < n; i++)
+            saida.push_back(std::move(estado->prontas[i]));
+        estado->prontas.erase(estado->prontas.begin(), estado->prontas.begin() + n);
+        return n;
+    }
+
+    // Trabalhos ainda não terminados de enviar à GPU: pendentes, em execução e prontos
+    size_t profundidade() const
+    {
+        std::lock_guard<std::mutex> trava(estado->mutex);
+        return estado->pendentes.size() + estado->emExecucao + estado->prontas.size();
+    }
+
+private:
+    struct Estado
+    {
+        mutable std::mutex mutex;
+        std::vector<TrabalhoMalha> pendentes; // heap: o mais próximo da câmera no topo
+        std::vector<MalhaPronta> prontas;
+        size_t emExecucao = 0;
+        glm::vec3 camera = glm::vec3(0.0f);
+    };
+
+    PoolThreads &pool;
+    std::shared_ptr<Estado> estado;
+
+    static float distancia2(glm::vec3 a, glm::vec3 b)
+    {
+        glm::vec3 d = a - b;
+        return glm::dot(d, d);
+    }
+
+    static bool maisLonge(const TrabalhoMalha &a, const TrabalhoMalha &b)
+    {
+        return a.distancia2 > b.distancia2;
+    }
+
+    static void executarProximo(Estado &e)
+    {
+        TrabalhoMalha t;
+        {
+            std::lock_guard<std::mutex> trava(e.mutex);
+            if (e.pendentes.empty())
+                return;
+            std::pop_heap(e.pendentes.begin(), e.pendentes.end(), maisLonge);
+            t = std::move(e.pendentes.back());
+            e.pendentes.pop_back();
+            e.emExecucao++;
+        }
+
+        MalhaPronta m;
+        m.chave = t.chave;
+        m.geracao = t.geracao;
+        const VizinhancaChunk &v = *t.vizinhanca;
+        gerarMalhaChunk([&v](int x, int y, int z) { return v.corEm(x, y, z); },
+                        v.cx, v.cy, v.cz, t.tam, t.origem, t.guloso, t.mascaraTranslucidas, m.vertices);
+
+        std::lock_guard<std::mutex> trava(e.mutex);
+        e.prontas.push_back(std::move(m));
+        e.emExecucao--;
+    }
+};
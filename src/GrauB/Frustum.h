@@ -0,0 +1,48 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// Frustum de visão extraído da matriz projeção * view (método de Gribb e Hartmann).
+// Cada plano é (a, b, c, d) com a normal apontando para dentro: um ponto p está do lado
+// de dentro quando a*p.x + b*p.y + c*p.z + d >= 0.
+struct Frustum
+{
+    glm::vec4 planos[6]; // esquerda, direita, baixo, cima, perto, longe
+};
+
+inline Frustum extrairFrustum(const glm::mat4 &projView)
+{
+    // glm guarda as matrizes por coluna: a linha i é (m[0][i], m[1][i], m[2][i], m[3][i])
+    glm::vec4 linha[4];
+    for (int i = 0; i < 4; i++)
+        linha[i] = glm::vec4(projView[0][i], projView[1][i], projView[2][i], projView[3][i]);
+
+    Frustum f;
+    f.planos[0] = linha[3] + linha[0];
+    f.planos[1] = linha[3] - linha[0];
+    f.planos[2] = linha[3] + linha[1];
+    f.planos[3] = linha[3] - linha[1];
+    f.planos[4] = linha[3] + linha[2];
+    f.planos[5] = linha[3] - linha[2];
+
+    for (int i = 0; i < 6; i++)
+        f.planos[i] /= glm::length(glm::vec3(f.planos[i]));
+    return f;
+}
+
+// Teste conservador de uma caixa alinhada aos eixos: para cada plano, só o canto mais
+// à frente (na direção da normal) é testado. Se ele estiver fora de algum plano, a caixa
+// inteira está fora; caixas que cruzam as quinas do frustum podem passar como visíveis.
+inline bool caixaNoFrustum(const Frustum &f, const glm::vec3 &minimo, const glm::vec3 &maximo)
+{
+    for (int i = 0; i < 6; i++)
+    {
+        const glm::vec4 &p = f.planos[i];
+        glm::vec3 canto(p.x >= 0.0f ? maximo.x : minimo.x,
+                        p.y >= 0.0f ? maximo.y : minimo.y,
+                        p.z >= 0.0f ? maximo.z : minimo.z);
+        if (p.x * canto.x + p.y * canto.y + p.z * canto.z + p.w < 0.0f)
+            return false;
+    }
+    return true;
+}
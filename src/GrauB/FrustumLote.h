@@ -0,0 +1,236 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <glm/glm.hpp>
+
+#include "Frustum.h"
+
+// Culling em lote: muitas caixas alinhadas aos eixos contra o frustum de uma vez.
+// As caixas ficam em estrutura de arrays (um vetor por coordenada), para que 8 caixas
+// (AVX2) ou 4 (SSE) sejam testadas por iteração contra os seis planos; o resultado é a lista
+// compacta dos índices das caixas visíveis, em ordem crescente.
+// O teste é o mesmo de caixaNoFrustum (só o canto mais à frente de cada plano), com as contas
+// na mesma ordem, então os três caminhos dão exatamente o mesmo resultado.
+// O caminho AVX2 é compilado à parte (atributo target) e escolhido em tempo de execução, de
+// modo que o executável continua rodando em processadores sem AVX2.
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define FRUSTUM_LOTE_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define ALVO_AVX2
+#else
+#define ALVO_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+struct CaixasSoA
+{
+    std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+
+    size_t tamanho() const { return minX.size(); }
+
+    void limpar()
+    {
+        minX.clear();
+        minY.clear();
+        minZ.clear();
+        maxX.clear();
+        maxY.clear();
+        maxZ.clear();
+    }
+
+    void adicionar(const glm::vec3 &minimo, const glm::vec3 &maximo)
+    {
+        minX.push_back(minimo.x);
+        minY.push_back(minimo.y);
+        minZ.push_back(minimo.z);
+        maxX.push_back(maximo.x);
+        maxY.push_back(maximo.y);
+        maxZ.push_back(maximo.z);
+    }
+};
+
+enum CaminhoCulling
+{
+    CULLING_ESCALAR,
+    CULLING_SSE,
+    CULLING_AVX2
+};
+
+const char *const NOMES_CAMINHO_CULLING[] = {"escalar", "SSE", "AVX2"};
+
+// Um plano com os vetores do canto mais à frente já escolhidos pelo sinal da normal
+struct PlanoLote
+{
+    float a, b, c, d;
+    const float *x, *y, *z;
+};
+
+inline void prepararPlanos(const Frustum &f, const CaixasSoA &caixas, PlanoLote planos[6])
+{
+    for (int k = 0; k < 6; k++)
+    {
+        const glm::vec4 &p = f.planos[k];
+        planos[k] = {p.x, p.y, p.z, p.w,
+                     (p.x >= 0.0f ? caixas.maxX : caixas.minX).data(),
+                     (p.y >= 0.0f ? caixas.maxY : caixas.minY).data(),
+                     (p.z >= 0.0f ? caixas.maxZ : caixas.minZ).data()};
+    }
+}
+
+// Caixas [inicio, fim) uma a uma; devolve quantos índices foram escritos em visiveis
+inline size_t recortarFaixaEscalar(const PlanoLote planos[6], size_t inicio, size_t fim, uint32_t *visiveis)
+{
+    size_t n = 0;
+    for (size_t i = inicio; i < fim; i++)
+    {
+        bool dentro = true;
+        for (int k = 0; k < 6; k++)
+        {
+            const PlanoLote &p = planos[k];
+            if (p.a * p.x[i] + p.b * p.y[i] + p.c * p.z[i] + p.d < 0.0f)
+            {
+                dentro = false;
+                break;
+            }
+        }
+        if (dentro)
+            visiveis[n++] = (uint32_t)i;
+    }
+    return n;
+}
+
+inline size_t recortarCaixasEscalar(const Frustum &f, const CaixasSoA &caixas, uint32_t *visiveis)
+{
+    PlanoLote planos[6];
+    prepararPlanos(f, caixas, planos);
+    return recortarFaixaEscalar(planos, 0, caixas.tamanho(), visiveis);
+}
+
+#ifdef FRUSTUM_LOTE_X86
+
+// 4 caixas por iteração; SSE2 faz parte de todo processador x86-64
+inline size_t recortarCaixasSSE(const Frustum &f, const CaixasSoA &caixas, uint32_t *visiveis)
+{
+    PlanoLote planos[6];
+    prepararPlanos(f, caixas, planos);
+    __m128 a[6], b[6], c[6], d[6];
+    for (int k = 0; k < 6; k++)
+    {
+        a[k] = _mm_set1_ps(planos[k].a);
+        b[k] = _mm_set1_ps(planos[k].b);
+        c[k] = _mm_set1_ps(planos[k].c);
+        d[k] = _mm_set1_ps(planos[k].d);
+    }
+    const __m128 zero = _mm_setzero_ps();
+
+    size_t total = caixas.tamanho(), n = 0, i = 0;
+    for (; i + 4 <= total; i += 4)
+    {
+        __m128 dentro = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int k = 0; k < 6; k++)
+        {
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(a[k], _mm_loadu_ps(planos[k].x + i)),
+                                                           _mm_mul_ps(b[k], _mm_loadu_ps(planos[k].y + i))),
+                                                _mm_mul_ps(c[k], _mm_loadu_ps(planos[k].z + i))),
+                                     d[k]);
+            dentro = _mm_and_ps(dentro, _mm_cmpnlt_ps(dist, zero)); // "não menor", como o escalar
+        }
+
+        // compactação sem desvios: escreve sempre e só avança quando a caixa é visível
+        int mascara = _mm_movemask_ps(dentro);
+        for (int l = 0; l < 4; l++)
+        {
+            visiveis[n] = (uint32_t)(i + l);
+            n += (mascara >> l) & 1;
+        }
+    }
+    return n + recortarFaixaEscalar(planos, i, total, visiveis + n);
+}
+
+// 8 caixas por iteração
+ALVO_AVX2 inline size_t recortarCaixasAVX2(const Frustum &f, const CaixasSoA &caixas, uint32_t *visiveis)
+{
+    PlanoLote planos[6];
+    prepararPlanos(f, caixas, planos);
+    __m256 a[6], b[6], c[6], d[6];
+    for (int k = 0; k < 6; k++)
+    {
+        a[k] = _mm256_set1_ps(planos[k].a);
+        b[k] = _mm256_set1_ps(planos[k].b);
+        c[k] = _mm256_set1_ps(planos[k].c);
+        d[k] = _mm256_set1_ps(planos[k].d);
+    }
+    const __m256 zero = _mm256_setzero_ps();
+
+    size_t total = caixas.tamanho(), n = 0, i = 0;
+    for (; i + 8 <= total; i += 8)
+    {
+        __m256 dentro = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int k = 0; k < 6; k++)
+        {
+            __m256 dist = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a[k], _mm256_loadu_ps(planos[k].x + i)),
+                                                                    _mm256_mul_ps(b[k], _mm256_loadu_ps(planos[k].y + i))),
+                                                      _mm256_mul_ps(c[k], _mm256_loadu_ps(planos[k].z + i))),
+                                        d[k]);
+            dentro = _mm256_and_ps(dentro, _mm256_cmp_ps(dist, zero, _CMP_NLT_UQ));
+        }
+
+        int mascara = _mm256_movemask_ps(dentro);
+        for (int l = 0; l < 8; l++)
+        {
+            visiveis[n] = (uint32_t)(i + l);
+            n += (mascara >> l) & 1;
+        }
+    }
+    return n + recortarFaixaEscalar(planos, i, total, visiveis + n);
+}
+
+inline bool processadorTemAVX2()
+{
+#ifdef _MSC_VER
+    int r[4];
+    __cpuid(r, 0);
+    if (r[0] < 7)
+        return false;
+    __cpuid(r, 1);
+    bool osxsave = (r[2] & (1 << 27)) != 0, avx = (r[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) // o sistema precisa salvar os registradores YMM
+        return false;
+    __cpuidex(r, 7, 0);
+    return (r[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+// O caminho mais rápido disponível neste processador (decidido uma vez)
+inline CaminhoCulling melhorCaminhoCulling()
+{
+#ifdef FRUSTUM_LOTE_X86
+    static const CaminhoCulling melhor = processadorTemAVX2() ? CULLING_AVX2 : CULLING_SSE;
+    return melhor;
+#else
+    return CULLING_ESCALAR;
+#endif
+}
+
+// Escreve em visiveis (capacidade para caixas.tamanho() índices) os índices das caixas que
+// passam no frustum e devolve quantos são; um caminho indisponível cai no melhor disponível
+inline size_t recortarCaixas(const Frustum &f, const CaixasSoA &caixas, uint32_t *visiveis,
+                             CaminhoCulling caminho = melhorCaminhoCulling())
+{
+#ifdef FRUSTUM_LOTE_X86
+    if (caminho == CULLING_AVX2 && melhorCaminhoCulling() == CULLING_AVX2)
+        return recortarCaixasAVX2(f, caixas, visiveis);
+    if (caminho != CULLING_ESCALAR)
+        return recortarCaixasSSE(f, caixas, visiveis);
+#endif
+    return recortarCaixasEscalar(f, caixas, visiveis);
+}
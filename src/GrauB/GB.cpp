@@ -1,11 +1,39 @@
 #include <iostream>
 #include <fstream>
+#include <vector>
+#include <cstdio>
+#include <cstddef>
+#include <cmath>
+#include <unordered_map>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <functional>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#ifdef _WIN32
+#define NOMINMAX // evita que as macros min/max do windows.h quebrem glm::min / glm::max
 #include <windows.h>
+#endif
+
+#include "GradeVoxel.h"
+#include "ArquivoVoxel.h"
+#include "MalhaVoxel.h"
+#include "InstanciasVoxel.h"
+#include "Frustum.h"
+#include "FrustumLote.h"
+#include "RaioVoxel.h"
+#include "OctreeVoxel.h"
+#include "HistoricoVoxel.h"
+#include "BenchmarkVoxel.h"
+#include "PoolThreads.h"
+#include "OperacoesVoxel.h"
+#include "FilaMalhas.h"
+#include "ExportacaoVoxel.h"
+#include "ProgramaShader.h"
 
 using namespace std;
 
@@ -29,22 +57,260 @@ float fov = 45.0f;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
+// Programas de shader: cor sólida por objeto, instanciado e malha por chunk.
+// View e projeção chegam a todos pelo bloco de câmera, enviado uma vez por frame.
+ProgramaShader programaCor, programaInst, programaMalha;
+BlocoCamera blocoCamera;
+GLint locModel, locCor; // uniforms do programa de cor usados a cada objeto desenhado
+
 // IDs de shader e VAO
 GLuint shaderID, VAO;
+GLuint cuboVBO;
 GLuint wireVAO, wireVBO;
 GLFWwindow *window;
 
-struct Voxel
+// Modo de renderização da grade: um draw call por voxel (imediato), um único draw instanciado,
+// malhas por chunk contendo apenas as faces expostas, ou a octree com nível de detalhe
+enum ModoRender
+{
+    RENDER_IMEDIATO,
+    RENDER_INSTANCIADO,
+    RENDER_MALHA,
+    RENDER_OCTREE
+};
+ModoRender modoRender = RENDER_INSTANCIADO;
+const char *NOMES_MODO[] = {"imediato", "instanciado", "malha", "octree"};
+
+// As instâncias ficam agrupadas por chunk, para que o culling possa pular segmentos inteiros;
+// editar um voxel só reenvia as instâncias que mudaram
+GLuint shaderInstID, instVAO, instVBO;
+InstanciasGrade instancias;
+bool instanciasSujas = true; // o layout inteiro precisa ser refeito (depois de carregar uma grade)
+
+// Desfazer / refazer: só os voxels alterados por edição, em anéis de memória fixa
+const size_t LIMITE_HISTORICO_BYTES = 4 << 20;
+HistoricoVoxel historico(LIMITE_HISTORICO_BYTES);
+
+// Operações em massa (caixa, esfera, substituir cor, inundação): calculadas no pool de threads
+// e aplicadas de uma vez. Caixa e esfera vão da âncora (tecla M) até a seleção.
+PoolThreads pool;
+int ancoraX, ancoraY, ancoraZ;
+uint8_t corAtual = 1;                                 // última cor escolhida nas teclas 1 a 0
+const size_t LIMITE_INUNDACAO = 256 * 256 * 256;       // voxels; evita inundar o vazio da grade inteira
+const size_t LIMITE_EDICAO_INCREMENTAL = VOXELS_POR_CHUNK; // acima disso instâncias e octree são refeitas
+
+// Malhas por chunk: cada chunk só é refeito quando um voxel dele (ou da sua borda) muda.
+// A geração roda nas threads do pool (FilaMalhas.h); a malha antiga continua sendo desenhada
+// até a nova chegar, e cada frame envia no máximo ORCAMENTO_MALHAS_POR_FRAME malhas à GPU.
+struct ChunkGL
+{
+    GLuint VAO = 0, VBO = 0;
+    GLsizei nVertices = 0;
+    bool sujo = true;
+    bool emFila = false; // há um trabalho deste chunk na fila; um novo só sai quando ele voltar
+};
+
+GLuint shaderMalhaID;
+std::unordered_map<uint64_t, ChunkGL> chunksMalha; // mesma chave dos chunks da grade
+bool malhaGulosa = true; // une faces coplanares da mesma cor
+FilaMalhas filaMalhas(pool);
+uint32_t geracaoMalhas = 0; // muda quando a grade é trocada: malhas em andamento viram lixo
+const size_t ORCAMENTO_MALHAS_POR_FRAME = 16;
+std::vector<MalhaPronta> malhasRecebidas;
+size_t profundidadeFilaMalhas = 0; // trabalhos de malha ainda não enviados, medido a cada frame
+
+// Nível de detalhe pela octree: cada região é desenhada na profundidade em que o lado de
+// uma célula ocupa no máximo limiarLOD pixels, então regiões distantes viram cubos maiores.
+// A lista de instâncias só é refeita quando a câmera ou a grade mudam.
+GLuint lodVAO, lodVBO;
+OctreeVoxel octree;
+bool octreeSuja = true; // a octree precisa ser construída (só é feita ao entrar no modo)
+std::vector<InstanciaVoxel> instanciasLOD;
+bool lodSujo = true;
+float limiarLOD = 2.0f; // pixels
+glm::vec3 lodCameraPos, lodCameraFront;
+float lodFov = 0.0f;
+
+// Transparência independente de ordem (weighted blended OIT, McGuire e Bavoil, 2013).
+// Os opacos são desenhados primeiro na cena fora da tela; os translúcidos acumulam cor
+// ponderada e "revelação" em dois alvos, testando contra a profundidade dos opacos sem
+// escrevê-la, e uma passada de composição mistura o resultado sobre a cena. Não há
+// ordenação por profundidade, então o resultado não depende da direção da câmera.
+enum PassoOIT
+{
+    PASSO_OPACO,
+    PASSO_TRANSLUCIDO
+};
+
+struct AlvosOIT
 {
-    glm::vec3 pos;
-    float fatorEscala;
-    bool visivel = true, selecionado = false;
-    int corPos;
+    GLuint fboCena = 0, texCena = 0, rboProfundidade = 0; // cena opaca + profundidade
+    GLuint fboOIT = 0, texAcumulo = 0, texRevelacao = 0;  // acumulação dos translúcidos
+    int largura = 0, altura = 0;
 };
 
+AlvosOIT alvosOIT;
+PassoOIT passoAtual = PASSO_OPACO; // as estatísticas de chunks e triângulos só contam a passada opaca
+ProgramaShader programaComposicao;
+GLuint composicaoVAO;
+GLint locPassoCor, locPassoInst, locPassoMalha;
+
+// Matrizes da câmera do frame atual e o frustum extraído delas
+glm::mat4 matrizView, matrizProj;
+Frustum frustum;
+
+// Gravação do caminho da câmera (F7), uma pose por frame, para repetir no modo de benchmark
+std::ofstream gravacaoCaminho;
+
+// Estatísticas de desempenho, exibidas no título da janela
+int chunksEnviados = 0, chunksDescartados = 0;
+int drawCallsFrame = 0;
+long long triangulosFrame = 0;
+long long bytesEnviadosFrame = 0; // dados de voxel enviados para a GPU no frame
+long long bytesEnviadosAmostrados = 0, picoBytesEnviados = 0;
+int framesAmostrados = 0;
+double tempoAmostrado = 0.0, tempoCPUAmostrado = 0.0;
+
+// A seleção é só um cursor: mover a seleção não escreve na grade nem cria chunks
 int selecaoX, selecaoY, selecaoZ;
 int TAM;            // Agora TAM será definido dinamicamente
-Voxel ***grid = nullptr; // Ponteiro triplo para alocação dinâmica
+GradeVoxel grade;   // grade esparsa: só os chunks com voxels visíveis ocupam memória
+
+void marcarChunkMalhaSujo(int cx, int cy, int cz)
+{
+    chunksMalha[GradeVoxel::chaveChunk(cx, cy, cz)].sujo = true;
+}
+
+// Marca o chunk do voxel como sujo, e também o chunk vizinho quando o voxel está na borda,
+// pois a face compartilhada entre os dois pode ter aparecido ou sumido
+void marcarChunkSujo(int x, int y, int z)
+{
+    int c[3] = {x / TAM_CHUNK, y / TAM_CHUNK, z / TAM_CHUNK};
+    int l[3] = {x % TAM_CHUNK, y % TAM_CHUNK, z % TAM_CHUNK};
+
+    marcarChunkMalhaSujo(c[0], c[1], c[2]);
+    for (int d = 0; d < 3; d++)
+    {
+        int viz[3] = {c[0], c[1], c[2]};
+        if (l[d] == 0 && c[d] > 0)
+            viz[d] = c[d] - 1;
+        else if (l[d] == TAM_CHUNK - 1 && (c[d] + 1) * TAM_CHUNK < TAM)
+            viz[d] = c[d] + 1;
+        else
+            continue;
+        marcarChunkMalhaSujo(viz[0], viz[1], viz[2]);
+    }
+}
+
+// Grava um voxel na grade e, se ele mudou, invalida as instâncias e as malhas afetadas.
+// Não entra no histórico: é o caminho usado pelo próprio desfazer / refazer.
+bool gravarVoxel(int x, int y, int z, Voxel v)
+{
+    if (!grade.escrever(x, y, z, v))
+        return false;
+    instancias.alterar(grade, x, y, z);
+    if (!octreeSuja)
+        octree.alterar(grade, x, y, z);
+    lodSujo = true;
+    marcarChunkSujo(x, y, z);
+    return true;
+}
+
+// Edição do usuário: grava o voxel e registra a mudança para poder desfazê-la
+void alterarVoxel(int x, int y, int z, Voxel v)
+{
+    Voxel antes = grade.ler(x, y, z);
+    if (gravarVoxel(x, y, z, v))
+        historico.registrar(x, y, z, antes, v);
+}
+
+// Aplica o resultado de uma operação em massa como uma única entrada do histórico.
+// Poucas mudanças seguem o caminho voxel a voxel; muitas são gravadas chunk a chunk e o
+// buffer de instâncias e a octree são refeitos inteiros, o que sai mais barato nesse caso.
+void aplicarOperacao(const ResultadoOperacao &resultado)
+{
+    size_t total = contarAlteracoes(resultado);
+    if (total == 0)
+        return;
+
+    historico.iniciar();
+    for (const AlteracoesChunk &a : resultado)
+    {
+        int x0 = a.cx * TAM_CHUNK, y0 = a.cy * TAM_CHUNK, z0 = a.cz * TAM_CHUNK;
+        if (total <= LIMITE_EDICAO_INCREMENTAL)
+        {
+            for (const AlteracaoVoxel &v : a.alteracoes)
+                alterarVoxel(x0 + v.local / (TAM_CHUNK * TAM_CHUNK), y0 + (v.local / TAM_CHUNK) % TAM_CHUNK, z0 + v.local % TAM_CHUNK, v.novo);
+            continue;
+        }
+
+        grade.editarChunk(a.cx, a.cy, a.cz, [&](ChunkVoxel &c)
+        {
+            for (const AlteracaoVoxel &v : a.alteracoes)
+            {
+                historico.registrar(x0 + v.local / (TAM_CHUNK * TAM_CHUNK), y0 + (v.local / TAM_CHUNK) % TAM_CHUNK, z0 + v.local % TAM_CHUNK,
+                                    c.voxels[v.local], v.novo);
+                c.voxels[v.local] = v.novo;
+            }
+        });
+
+        // o chunk e os seis vizinhos, pelas faces compartilhadas
+        marcarChunkMalhaSujo(a.cx, a.cy, a.cz);
+        int c[3] = {a.cx, a.cy, a.cz};
+        for (int d = 0; d < 3; d++)
+            for (int passo = -1; passo <= 1; passo += 2)
+            {
+                int viz[3] = {c[0], c[1], c[2]};
+                viz[d] += passo;
+                if (viz[d] >= 0 && viz[d] * TAM_CHUNK < TAM)
+                    marcarChunkMalhaSujo(viz[0], viz[1], viz[2]);
+            }
+    }
+    historico.concluir();
+
+    if (total > LIMITE_EDICAO_INCREMENTAL)
+    {
+        instanciasSujas = true;
+        octreeSuja = true;
+        lodSujo = true;
+    }
+}
+
+// Calcula a operação no pool, aplica e informa os tempos no console
+template <typename Fn>
+void executarOperacao(const char *nome, Fn calcular)
+{
+    double inicio = glfwGetTime();
+    ResultadoOperacao resultado;
+    if (!calcular(resultado))
+    {
+        std::cout << nome << ": região grande demais (mais de " << LIMITE_INUNDACAO << " voxels), nada foi alterado\n";
+        return;
+    }
+    double calculado = glfwGetTime();
+    aplicarOperacao(resultado);
+    double aplicado = glfwGetTime();
+    printf("%s: %zu voxels alterados em %.1f ms (cálculo %.1f ms em %u threads + 1, aplicação %.1f ms)\n", nome,
+           contarAlteracoes(resultado), 1000.0 * (aplicado - inicio), 1000.0 * (calculado - inicio), pool.quantidade(),
+           1000.0 * (aplicado - calculado));
+}
+
+void liberarChunkMalha(ChunkGL &c)
+{
+    glDeleteBuffers(1, &c.VBO);
+    glDeleteVertexArrays(1, &c.VAO);
+}
+
+// Descarta todas as malhas e marca como sujos os chunks que existem na grade
+void inicializarChunksMalha()
+{
+    for (auto &par : chunksMalha)
+        liberarChunkMalha(par.second);
+    chunksMalha.clear();
+    geracaoMalhas++;
+    for (const auto &par : grade.chunks)
+        chunksMalha[par.first].sujo = true;
+}
 
 glm::vec4 colorList[] = {
     {0.5f, 0.5f, 0.5f, 0.5f}, // cinza
@@ -63,96 +329,308 @@ glm::vec4 colorList[] = {
 const GLchar *vertexShaderSource = R"glsl(
     #version 450
     layout(location = 0) in vec3 position;
+    layout(std140) uniform Camera { mat4 view; mat4 proj; };
     uniform mat4 model;
-    uniform mat4 view;
-    uniform mat4 proj;
+    uniform vec4 uColor;
+    out vec4 vColor;
     void main() {
+        vColor = uColor;
         gl_Position = proj * view * model * vec4(position, 1.0);
     }
 )glsl";
 
-// Código do Fragment Shader
-const GLchar *fragmentShaderSource = R"glsl(
+// Vertex Shader do modo de malha: cada vértice já está em coordenadas de mundo e carrega sua cor
+const GLchar *vertexShaderMalhaSource = R"glsl(
     #version 450
-    uniform vec4 uColor;
+    layout(location = 0) in vec3 position;
+    layout(location = 1) in uint cor;
+    layout(std140) uniform Camera { mat4 view; mat4 proj; };
+    uniform vec4 uPaleta[10];
+    uniform int uPassoOIT;
+    out vec4 vColor;
+    void main() {
+        vColor = uPaleta[cor];
+        gl_Position = proj * view * vec4(position, 1.0);
+        // vértice de outra passada: fica fora do volume de recorte e o triângulo é descartado
+        if ((uPassoOIT == 0) != (vColor.a >= 1.0))
+            gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+    }
+)glsl";
+
+// Vertex Shader do modo instanciado: a posição, a escala e a cor vêm do buffer de instâncias
+const GLchar *vertexShaderInstSource = R"glsl(
+    #version 450
+    layout(location = 0) in vec3 position;
+    layout(location = 1) in vec4 instPosEscala;
+    layout(location = 2) in uint instDados;
+    layout(std140) uniform Camera { mat4 view; mat4 proj; };
+    uniform vec4 uPaleta[10];
+    uniform int uPassoOIT;
+    out vec4 vColor;
+    void main() {
+        vColor = uPaleta[instDados];
+        gl_Position = proj * view * vec4(position * instPosEscala.w + instPosEscala.xyz, 1.0);
+        // instância de outra passada: fica fora do volume de recorte e o cubo é descartado
+        if ((uPassoOIT == 0) != (vColor.a >= 1.0))
+            gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+    }
+)glsl";
+
+// Fragment Shader comum aos três programas. Na passada opaca escreve a cor; na translúcida
+// escreve a cor pré-multiplicada com peso por profundidade e a cobertura para a revelação
+const GLchar *fragmentShaderOITSource = R"glsl(
+    #version 450
+    in vec4 vColor;
+    uniform int uPassoOIT; // 0: opacos, 1: translúcidos
+    layout(location = 0) out vec4 color;
+    layout(location = 1) out float revelacao;
+    void main() {
+        if (uPassoOIT == 0) {
+            if (vColor.a < 1.0)
+                discard;
+            color = vColor;
+            return;
+        }
+        if (vColor.a >= 1.0)
+            discard;
+        float peso = clamp(pow(min(1.0, vColor.a * 10.0) + 0.01, 3.0) * 1e8 * pow(1.0 - gl_FragCoord.z * 0.9, 3.0), 1e-2, 3e3);
+        color = vec4(vColor.rgb * vColor.a, vColor.a) * peso;
+        revelacao = vColor.a;
+    }
+)glsl";
+
+// Composição: um triângulo que cobre a tela lê os alvos de acumulação e mistura a média
+// ponderada dos translúcidos sobre a cena opaca
+const GLchar *vertexShaderComposicaoSource = R"glsl(
+    #version 450
+    void main() {
+        vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+        gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);
+    }
+)glsl";
+
+const GLchar *fragmentShaderComposicaoSource = R"glsl(
+    #version 450
+    uniform sampler2D uAcumulo;
+    uniform sampler2D uRevelacao;
     out vec4 color;
     void main() {
-        color = uColor;
+        ivec2 p = ivec2(gl_FragCoord.xy);
+        float revelacao = texelFetch(uRevelacao, p, 0).r;
+        if (revelacao >= 1.0)
+            discard; // nenhum translúcido neste pixel
+        vec4 acumulo = texelFetch(uAcumulo, p, 0);
+        color = vec4(acumulo.rgb / max(acumulo.a, 1e-5), 1.0 - revelacao);
     }
 )glsl";
 
-void salvarGradeVoxel(const std::string &nomeArquivo)
+void inicializarGradeVoxel(int tamanho);
+void enviarPaleta();
+
+// Depois de qualquer carregamento: ajusta a seleção e invalida instâncias e malhas
+void gradeCarregada()
+{
+    TAM = grade.tam;
+
+    // a seleção atual pode ter ficado fora de uma grade menor
+    selecaoX = glm::min(selecaoX, TAM - 1);
+    selecaoY = glm::min(selecaoY, TAM - 1);
+    selecaoZ = glm::min(selecaoZ, TAM - 1);
+
+    instanciasSujas = true;
+    octreeSuja = true;
+    inicializarChunksMalha();
+
+    // as edições anteriores referem-se à grade que foi trocada
+    historico.limpar();
+}
+
+// Operação de arquivo rodando em uma thread de trabalho, para que o editor não congele.
+// Só uma tarefa roda por vez; o resultado de um carregamento é trocado pela grade atual
+// entre dois frames, em verificarTarefaArquivo.
+struct TarefaArquivo
+{
+    std::thread thread;
+    std::atomic<bool> concluida{false};
+    std::atomic<float> progresso{0.0f};
+    std::string descricao;
+    bool carregamento = false;
+    bool ok = false;
+
+    GradeVoxel grade;               // instantâneo a gravar, ou grade lida do arquivo
+    std::vector<glm::vec4> paleta;  // paleta a gravar, ou paleta lida do arquivo
+    glm::ivec3 selecao;
+};
+
+std::unique_ptr<TarefaArquivo> tarefaArquivo;
+
+// Cria a tarefa, ou devolve nullptr se outra ainda estiver rodando
+TarefaArquivo *novaTarefaArquivo(const char *descricao, bool carregamento)
 {
-    std::ofstream arquivo(nomeArquivo);
-    if (!arquivo.is_open())
+    if (tarefaArquivo)
     {
-        std::cerr << "Erro ao abrir arquivo para escrita.\n";
-        return;
+        std::cout << "Aguarde: ainda " << tarefaArquivo->descricao << " o arquivo.\n";
+        return nullptr;
     }
+    tarefaArquivo.reset(new TarefaArquivo());
+    tarefaArquivo->descricao = descricao;
+    tarefaArquivo->carregamento = carregamento;
+    tarefaArquivo->selecao = glm::ivec3(selecaoX, selecaoY, selecaoZ);
+    return tarefaArquivo.get();
+}
 
-    arquivo << TAM << "\n"; //grava no arquivo o tamanho da matriz tridimensional na primeira linha
-
-    for (int x = 0; x < TAM; ++x)
+void executarTarefaArquivo(TarefaArquivo *t, std::function<bool(TarefaArquivo &)> trabalho)
+{
+    t->thread = std::thread([t, trabalho]()
     {
-        for (int y = 0; y < TAM; ++y)
+        // uma exceção que saísse da thread encerraria o editor, com o trabalho não salvo
+        try
         {
-            for (int z = 0; z < TAM; ++z)
-            {
-                const Voxel &v = grid[x][y][z];
-                arquivo << v.pos.x << " " << v.pos.y << " " << v.pos.z << " "
-                        << v.fatorEscala << " "
-                        << v.visivel << " " << v.selecionado << " "
-                        << v.corPos << "\n";
-            }
+            t->ok = trabalho(*t);
         }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Erro " << t->descricao << " o arquivo: " << e.what() << "\n";
+            t->ok = false;
+        }
+        catch (...)
+        {
+            std::cerr << "Erro desconhecido " << t->descricao << " o arquivo.\n";
+            t->ok = false;
+        }
+        t->concluida = true;
+    });
+}
+
+// Troca a grade atual pela lida do arquivo, junto com a paleta e a seleção gravadas
+void aplicarGradeLida(TarefaArquivo &t)
+{
+    std::swap(grade, t.grade);
+
+    // a paleta gravada substitui a atual quando tem o mesmo número de cores
+    if (t.paleta.size() == 10)
+    {
+        for (int i = 0; i < 10; i++)
+            colorList[i] = t.paleta[i];
+        enviarPaleta();
     }
+    selecaoX = t.selecao.x;
+    selecaoY = t.selecao.y;
+    selecaoZ = t.selecao.z;
+    gradeCarregada();
+}
+
+// Chamada a cada frame: quando a tarefa termina, aplica o resultado e libera a thread
+void verificarTarefaArquivo()
+{
+    if (!tarefaArquivo || !tarefaArquivo->concluida)
+        return;
+
+    TarefaArquivo &t = *tarefaArquivo;
+    t.thread.join();
 
-    arquivo.close();
+    if (t.carregamento && t.ok)
+        aplicarGradeLida(t);
+    std::cout << (t.ok ? "Concluído: " : "Falhou: ") << t.descricao << " o arquivo.\n";
+
+    // o que sobrou em t.grade (a grade antiga, depois de carregar, ou o instantâneo gravado) pode
+    // ter milhares de chunks; liberá-los aqui travaria o frame, então vão para o pool
+    pool.enfileirar([antiga = std::make_shared<GradeVoxel>(std::move(t.grade))]() mutable { antiga.reset(); });
+    tarefaArquivo.reset();
 }
 
-void carregarGradeVoxel(const std::string &nomeArquivo)
+// Formato binário com RLE por chunk (ver ArquivoVoxel.h).
+// A gravação tira um instantâneo da grade (chunks compartilhados, copiados só quando o editor
+// escreve neles durante a gravação) e grava em segundo plano.
+void salvarGradeVoxel(const std::string &nomeArquivo)
 {
-    std::ifstream arquivo(nomeArquivo);
-    if (!arquivo.is_open())
+    TarefaArquivo *t = novaTarefaArquivo("salvando", false);
+    if (!t)
+        return;
+    t->grade = grade.instantaneo();
+    t->paleta.assign(colorList, colorList + 10);
+    executarTarefaArquivo(t, [nomeArquivo](TarefaArquivo &tarefa)
     {
-        std::cerr << "Erro ao abrir arquivo para leitura.\n";
+        return salvarGradeBinaria(tarefa.grade, tarefa.paleta.data(), (uint32_t)tarefa.paleta.size(), nomeArquivo, &tarefa.progresso);
+    });
+}
+
+void carregarGradeVoxel(const std::string &nomeArquivo)
+{
+    TarefaArquivo *t = novaTarefaArquivo("carregando", true);
+    if (!t)
         return;
-    }
+    executarTarefaArquivo(t, [nomeArquivo](TarefaArquivo &tarefa)
+    {
+        return carregarGradeBinaria(tarefa.grade, nomeArquivo, &tarefa.paleta, &tarefa.progresso);
+    });
+}
 
-    // Lê o tamanho da matriz
-    arquivo >> TAM;
+// Formato texto de sete campos, mantido para importação / exportação
+void exportarGradeTexto(const std::string &nomeArquivo)
+{
+    TarefaArquivo *t = novaTarefaArquivo("exportando", false);
+    if (!t)
+        return;
+    t->grade = grade.instantaneo();
+    executarTarefaArquivo(t, [nomeArquivo](TarefaArquivo &tarefa)
+    {
+        return salvarGradeTexto(tarefa.grade, nomeArquivo, tarefa.selecao, &tarefa.progresso);
+    });
+}
 
-    // Aloca dinamicamente a grade
-    grid = new Voxel **[TAM];
-    for (int x = 0; x < TAM; ++x)
+void importarGradeTexto(const std::string &nomeArquivo)
+{
+    TarefaArquivo *t = novaTarefaArquivo("importando", true);
+    if (!t)
+        return;
+    executarTarefaArquivo(t, [nomeArquivo](TarefaArquivo &tarefa)
     {
-        grid[x] = new Voxel *[TAM];
-        for (int y = 0; y < TAM; ++y)
-        {
-            grid[x][y] = new Voxel[TAM];
-        }
-    }
+        return carregarGradeTexto(tarefa.grade, nomeArquivo, tarefa.selecao, &tarefa.progresso);
+    });
+}
 
-    // Lê os dados dos voxels
-    for (int x = 0; x < TAM; ++x)
+// Malha com faces escondidas removidas, para outras ferramentas: OBJ (+ .mtl) ou glTF binário.
+// Usa a paleta atual e o modo guloso ligado no momento.
+void exportarMalha(const std::string &nomeArquivo, bool glb)
+{
+    TarefaArquivo *t = novaTarefaArquivo("exportando", false);
+    if (!t)
+        return;
+    t->grade = grade.instantaneo();
+    t->paleta.assign(colorList, colorList + 10);
+    bool guloso = malhaGulosa;
+    executarTarefaArquivo(t, [nomeArquivo, glb, guloso](TarefaArquivo &tarefa)
     {
-        for (int y = 0; y < TAM; ++y)
-        {
-            for (int z = 0; z < TAM; ++z)
-            {
-                Voxel &v = grid[x][y][z];
-                arquivo >> v.pos.x >> v.pos.y >> v.pos.z >> v.fatorEscala >> v.visivel >> v.selecionado >> v.corPos;
-            }
-        }
-    }
+        const glm::vec4 *paleta = tarefa.paleta.data();
+        int nCores = (int)tarefa.paleta.size();
+        return glb ? exportarMalhaGLB(tarefa.grade, paleta, nCores, guloso, nomeArquivo, &tarefa.progresso)
+                   : exportarMalhaOBJ(tarefa.grade, paleta, nCores, guloso, nomeArquivo, &tarefa.progresso);
+    });
+}
 
-    arquivo.close();
+// Modelo do MagicaVoxel; as cores do arquivo são aproximadas pela paleta atual, que não muda
+void importarGradeVox(const std::string &nomeArquivo)
+{
+    TarefaArquivo *t = novaTarefaArquivo("importando", true);
+    if (!t)
+        return;
+    t->paleta.assign(colorList, colorList + 10);
+    executarTarefaArquivo(t, [nomeArquivo](TarefaArquivo &tarefa)
+    {
+        bool ok = carregarGradeVox(tarefa.grade, nomeArquivo, tarefa.paleta.data(), (int)tarefa.paleta.size(), &tarefa.progresso);
+        tarefa.paleta.clear();
+        return ok;
+    });
 }
 
+void criarAlvosOIT(int largura, int altura);
+
 // Atualiza o viewport ao redimensionar a janela
 void framebuffer_size_callback(GLFWwindow *window, int width, int height)
 {
     glViewport(0, 0, width, height);
+    criarAlvosOIT(width, height);
 }
 
 // Callback para movimentação do mouse — controla rotação da câmera
@@ -202,28 +680,203 @@ void scroll_callback(GLFWwindow *window, double xoffset, double yoffset)
         fov = 120.0f;
 }
 
+// Raio que sai da câmera pelo cursor; com o cursor preso (modo de olhar), pelo centro da tela
+void raioDoCursor(glm::vec3 &origem, glm::vec3 &direcao)
+{
+    int largura, altura;
+    glfwGetWindowSize(window, &largura, &altura);
+    double cursorX = largura / 2.0, cursorY = altura / 2.0;
+    if (glfwGetInputMode(window, GLFW_CURSOR) == GLFW_CURSOR_NORMAL)
+        glfwGetCursorPos(window, &cursorX, &cursorY);
+
+    // do cursor para o plano de fundo, desfazendo projeção e visualização do último frame
+    glm::vec4 ndc(2.0f * (float)cursorX / largura - 1.0f, 1.0f - 2.0f * (float)cursorY / altura, 1.0f, 1.0f);
+    glm::vec4 longe = glm::inverse(matrizProj * matrizView) * ndc;
+    origem = cameraPos;
+    direcao = glm::vec3(longe) / longe.w - cameraPos;
+}
+
+// Seleciona o primeiro voxel sólido sob o cursor, ou a célula vazia encostada na face atingida
+// (para colocar um voxel novo ao lado de um existente)
+void selecionarComMouse(bool celulaVizinha)
+{
+    glm::vec3 origem, direcao;
+    raioDoCursor(origem, direcao);
+
+    AcertoVoxel acerto;
+    if (!lancarRaio(grade, origem, direcao, 4.0f * TAM, acerto))
+        return;
+
+    glm::ivec3 alvo = acerto.voxel;
+    if (celulaVizinha)
+        alvo += acerto.normal;
+    if (!grade.dentro(alvo.x, alvo.y, alvo.z))
+        return;
+
+    selecaoX = alvo.x;
+    selecaoY = alvo.y;
+    selecaoZ = alvo.z;
+}
+
+// Callback dos botões do mouse — o botão esquerdo seleciona pelo raio
+void mouse_button_callback(GLFWwindow *window, int button, int action, int mods)
+{
+    if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
+        selecionarComMouse((mods & GLFW_MOD_SHIFT) != 0);
+}
+
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode)
 {
     // salvar do arquivo - F1
     if (key == GLFW_KEY_F1 && action == GLFW_PRESS)
     {
-        salvarGradeVoxel("minecraft.txt");
+        salvarGradeVoxel("minecraft.voxb");
     }
 
     // carregar do arquivo - F2
     if (key == GLFW_KEY_F2 && action == GLFW_PRESS)
     {
-        carregarGradeVoxel("minecraft.txt");
+        carregarGradeVoxel("minecraft.voxb");
+    }
+
+    // exportar / importar no formato texto - F5 / F6
+    if (key == GLFW_KEY_F5 && action == GLFW_PRESS)
+    {
+        exportarGradeTexto("minecraft.txt");
+    }
+    if (key == GLFW_KEY_F6 && action == GLFW_PRESS)
+    {
+        importarGradeTexto("minecraft.txt");
+    }
+
+    // importar modelo do MagicaVoxel - F8
+    if (key == GLFW_KEY_F8 && action == GLFW_PRESS)
+    {
+        importarGradeVox("modelo.vox");
+    }
+
+    // exportar a malha em OBJ / glTF binário - F9 / F10
+    if (key == GLFW_KEY_F9 && action == GLFW_PRESS)
+    {
+        exportarMalha("minecraft.obj", false);
+    }
+    if (key == GLFW_KEY_F10 && action == GLFW_PRESS)
+    {
+        exportarMalha("minecraft.glb", true);
+    }
+
+    // alterna entre os modos imediato, instanciado, malha e octree - F3
+    if (key == GLFW_KEY_F3 && action == GLFW_PRESS)
+    {
+        modoRender = (ModoRender)((modoRender + 1) % 4);
+        framesAmostrados = 0;
+        tempoAmostrado = tempoCPUAmostrado = 0.0;
+        bytesEnviadosAmostrados = picoBytesEnviados = 0;
+    }
+
+    // liga / desliga a união gulosa de faces - F4
+    if (key == GLFW_KEY_F4 && action == GLFW_PRESS)
+    {
+        malhaGulosa = !malhaGulosa;
+        for (auto &par : chunksMalha)
+            par.second.sujo = true;
+    }
+
+    // grava / para de gravar o caminho da câmera em caminho.txt - F7
+    if (key == GLFW_KEY_F7 && action == GLFW_PRESS)
+    {
+        if (gravacaoCaminho.is_open())
+        {
+            gravacaoCaminho.close();
+            std::cout << "Caminho da câmera gravado em caminho.txt\n";
+        }
+        else
+        {
+            gravacaoCaminho.open("caminho.txt");
+            std::cout << "Gravando o caminho da câmera (F7 para parar)\n";
+        }
+    }
+
+    // operações em massa: M marca a âncora; B preenche a caixa e O a esfera da âncora até a
+    // seleção (com SHIFT, apagam); R troca a cor do voxel selecionado pela atual em toda a
+    // grade; F inunda a partir da seleção com a cor atual
+    if (action == GLFW_PRESS && !(mode & GLFW_MOD_CONTROL))
+    {
+        glm::ivec3 selecao(selecaoX, selecaoY, selecaoZ), ancora(ancoraX, ancoraY, ancoraZ);
+        Voxel cheio;
+        cheio.corPos = corAtual;
+        cheio.visivel = true;
+        Voxel v = (mode & GLFW_MOD_SHIFT) ? Voxel() : cheio;
+
+        if (key == GLFW_KEY_M)
+        {
+            ancoraX = selecaoX;
+            ancoraY = selecaoY;
+            ancoraZ = selecaoZ;
+            std::cout << "Âncora em (" << ancoraX << ", " << ancoraY << ", " << ancoraZ << ")\n";
+        }
+        else if (key == GLFW_KEY_B)
+            executarOperacao("Caixa", [&](ResultadoOperacao &r)
+            {
+                r = preencherCaixa(grade, pool, ancora, selecao, v);
+                return true;
+            });
+        else if (key == GLFW_KEY_O)
+            executarOperacao("Esfera", [&](ResultadoOperacao &r)
+            {
+                r = preencherEsfera(grade, pool, ancora, glm::length(glm::vec3(selecao - ancora)) + 0.5f, v);
+                return true;
+            });
+        else if (key == GLFW_KEY_R)
+        {
+            Voxel alvo = grade.ler(selecaoX, selecaoY, selecaoZ);
+            if (alvo.visivel)
+                executarOperacao("Substituir cor", [&](ResultadoOperacao &r)
+                {
+                    r = substituirCor(grade, pool, alvo.corPos, corAtual);
+                    return true;
+                });
+        }
+        else if (key == GLFW_KEY_F)
+            executarOperacao("Inundação", [&](ResultadoOperacao &r)
+            {
+                return preencherInundacao(grade, pool, selecao, cheio, LIMITE_INUNDACAO, r);
+            });
+    }
+
+    // desfazer - CTRL + Z; refazer - CTRL + Y ou CTRL + SHIFT + Z
+    if ((action == GLFW_PRESS || action == GLFW_REPEAT) && (mode & GLFW_MOD_CONTROL))
+    {
+        if (key == GLFW_KEY_Z && !(mode & GLFW_MOD_SHIFT))
+            historico.desfazer(gravarVoxel);
+        else if (key == GLFW_KEY_Y || key == GLFW_KEY_Z)
+            historico.refazer(gravarVoxel);
+    }
+
+    // limiar de detalhe da octree, em pixels - [ / ]
+    if (key == GLFW_KEY_LEFT_BRACKET && action == GLFW_PRESS)
+    {
+        limiarLOD = glm::max(limiarLOD * 0.5f, 0.5f);
+        lodSujo = true;
+    }
+    if (key == GLFW_KEY_RIGHT_BRACKET && action == GLFW_PRESS)
+    {
+        limiarLOD = glm::min(limiarLOD * 2.0f, 64.0f);
+        lodSujo = true;
     }
 
     // troca a visibilidade de um voxel selecionado
     if (key == GLFW_KEY_DELETE && action == GLFW_PRESS)
     {
-        grid[selecaoY][selecaoX][selecaoZ].visivel = false;
+        Voxel v = grade.ler(selecaoX, selecaoY, selecaoZ);
+        v.visivel = false;
+        alterarVoxel(selecaoX, selecaoY, selecaoZ, v);
     }
     if (key == GLFW_KEY_V && action == GLFW_PRESS)
     {
-        grid[selecaoY][selecaoX][selecaoZ].visivel = true;
+        Voxel v = grade.ler(selecaoX, selecaoY, selecaoZ);
+        v.visivel = true;
+        alterarVoxel(selecaoX, selecaoY, selecaoZ, v);
     }
 
     // testa a seleção do voxel na grid
@@ -235,20 +888,16 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
     {
         if (selecaoX + 1 < TAM)
         {
-            grid[selecaoY][selecaoX][selecaoZ].selecionado = false;
             selecaoX++;
             mudouSelecao = true;
-            grid[selecaoY][selecaoX][selecaoZ].selecionado = true;
         }
     }
     if (key == GLFW_KEY_LEFT && action == GLFW_PRESS)
     {
         if (selecaoX - 1 >= 0)
         {
-            grid[selecaoY][selecaoX][selecaoZ].selecionado = false;
             selecaoX--;
             mudouSelecao = true;
-            grid[selecaoY][selecaoX][selecaoZ].selecionado = true;
         }
     }
 
@@ -256,20 +905,16 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
     {
         if (selecaoY + 1 < TAM)
         {
-            grid[selecaoY][selecaoX][selecaoZ].selecionado = false;
             selecaoY++;
             mudouSelecao = true;
-            grid[selecaoY][selecaoX][selecaoZ].selecionado = true;
         }
     }
     if (key == GLFW_KEY_DOWN && action == GLFW_PRESS)
     {
         if (selecaoY - 1 >= 0)
         {
-            grid[selecaoY][selecaoX][selecaoZ].selecionado = false;
             selecaoY--;
             mudouSelecao = true;
-            grid[selecaoY][selecaoX][selecaoZ].selecionado = true;
         }
     }
 
@@ -277,20 +922,16 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
     {
         if (selecaoZ + 1 < TAM)
         {
-            grid[selecaoY][selecaoX][selecaoZ].selecionado = false;
             selecaoZ++;
             mudouSelecao = true;
-            grid[selecaoY][selecaoX][selecaoZ].selecionado = true;
         }
     }
     if (key == GLFW_KEY_E && action == GLFW_PRESS)
     {
         if (selecaoZ - 1 >= 0)
         {
-            grid[selecaoY][selecaoX][selecaoZ].selecionado = false;
             selecaoZ--;
             mudouSelecao = true;
-            grid[selecaoY][selecaoX][selecaoZ].selecionado = true;
         }
     }
 
@@ -309,8 +950,11 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
 
         if (corEscolhida >= 0 && corEscolhida < 10)
         {
-            grid[selecaoY][selecaoX][selecaoZ].corPos = corEscolhida;
-            grid[selecaoY][selecaoX][selecaoZ].visivel = true;
+            corAtual = (uint8_t)corEscolhida;
+            Voxel v;
+            v.corPos = (uint8_t)corEscolhida;
+            v.visivel = true;
+            alterarVoxel(selecaoX, selecaoY, selecaoZ, v);
         }
     }
 }
@@ -342,17 +986,24 @@ void processInput(GLFWwindow *window)
 // Define a matriz de visualização usando a posição e direção da câmera
 void especificaVisualizacao()
 {
-    glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
-    GLuint loc = glGetUniformLocation(shaderID, "view");
-    glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(view));
+    matrizView = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
 }
 
 // Define a matriz de projeção perspectiva com base no FOV
 void especificaProjecao()
 {
-    glm::mat4 proj = glm::perspective(glm::radians(fov), (float)WIDTH / HEIGHT, 0.1f, 100.0f);
-    GLuint loc = glGetUniformLocation(shaderID, "proj");
-    glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(proj));
+    // o plano de fundo acompanha o tamanho da grade para que ela possa ser vista inteira
+    float zFar = glm::max(100.0f, 2.0f * TAM);
+    matrizProj = glm::perspective(glm::radians(fov), (float)WIDTH / HEIGHT, 0.1f, zFar);
+}
+
+// Calcula as matrizes do frame, envia-as para o bloco de câmera compartilhado e extrai o frustum
+void atualizarCamera()
+{
+    especificaVisualizacao();
+    especificaProjecao();
+    blocoCamera.enviar(matrizView, matrizProj);
+    frustum = extrairFrustum(matrizProj * matrizView);
 }
 
 void transformaObjeto(float xpos, float ypos, float zpos, float xrot, float yrot, float zrot, float sx, float sy, float sz)
@@ -369,54 +1020,7 @@ void transformaObjeto(float xpos, float ypos, float zpos, float xrot, float yrot
     transform = glm::scale(transform, glm::vec3(sx, sy, sz));
 
     // Envia os dados para o shader
-    GLuint loc = glGetUniformLocation(shaderID, "model");
-    glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(transform));
-}
-
-// Compila shaders e cria o programa de shader
-GLuint setupShader()
-{
-    GLint success;
-    GLchar infoLog[512];
-
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
-    glCompileShader(vertexShader);
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(vertexShader, 512, nullptr, infoLog);
-        cout << "Vertex Shader error:\n"
-             << infoLog << endl;
-    }
-
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, nullptr);
-    glCompileShader(fragmentShader);
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(fragmentShader, 512, nullptr, infoLog);
-        cout << "Fragment Shader error:\n"
-             << infoLog << endl;
-    }
-
-    GLuint shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success)
-    {
-        glGetProgramInfoLog(shaderProgram, 512, nullptr, infoLog);
-        cout << "Shader Program Linking error:\n"
-             << infoLog << endl;
-    }
-
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
-    return shaderProgram;
+    glUniformMatrix4fv(locModel, 1, GL_FALSE, glm::value_ptr(transform));
 }
 
 // Cria o VAO com os vértices e cores do cubo 3D
@@ -456,6 +1060,7 @@ GLuint setupGeometry()
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 
+    cuboVBO = VBO;
     return vao;
 }
 
@@ -495,54 +1100,673 @@ GLuint setupWireframeCube() {
     return vao;
 }
 
-void setColor(GLuint shaderID, glm::vec4 cor)
+// Cria um VAO instanciado: reaproveita os vértices do cubo e adiciona os atributos por instância,
+// lidos do buffer criado em vbo (usado pelos modos instanciado e octree)
+GLuint setupGeometriaInstanciada(GLuint &vbo)
+{
+    GLuint vao;
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+
+    glBindVertexArray(vao);
+
+    // atributo 0: vértices do cubo, lidos do mesmo VBO do VAO imediato
+    glBindBuffer(GL_ARRAY_BUFFER, cuboVBO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (GLvoid *)0);
+    glEnableVertexAttribArray(0);
+
+    // atributos 1 e 2: avançam uma vez por instância
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(InstanciaVoxel), (GLvoid *)offsetof(InstanciaVoxel, posEscala));
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+    glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, sizeof(InstanciaVoxel), (GLvoid *)offsetof(InstanciaVoxel, dados));
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+
+    return vao;
+}
+
+// Refaz a lista de instâncias com os voxels visíveis e envia para a GPU
+// Envia para a GPU só as faixas de instâncias que mudaram desde o último frame, já unidas;
+// o buffer inteiro só vai quando o layout é refeito
+void atualizarInstancias()
 {
-    GLint loc = glGetUniformLocation(shaderID, "uColor");
-    glUniform4f(loc, cor.r, cor.g, cor.b, cor.a);
+    if (instanciasSujas)
+    {
+        instancias.reconstruir(grade);
+        instanciasSujas = false;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, instVBO);
+    if (instancias.realocar)
+    {
+        GLsizeiptr tamanho = instancias.dados.size() * sizeof(InstanciaVoxel);
+        glBufferData(GL_ARRAY_BUFFER, tamanho, instancias.dados.data(), GL_DYNAMIC_DRAW);
+        bytesEnviadosFrame += tamanho;
+        instancias.realocar = false;
+    }
+    else
+    {
+        instancias.sujas.coalescer();
+        for (const auto &f : instancias.sujas.faixas)
+        {
+            GLsizeiptr tamanho = (f.second - f.first) * sizeof(InstanciaVoxel);
+            glBufferSubData(GL_ARRAY_BUFFER, f.first * sizeof(InstanciaVoxel), tamanho, &instancias.dados[f.first]);
+            bytesEnviadosFrame += tamanho;
+        }
+    }
+    instancias.sujas.limpar();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
-// inicializa a grid
-void inicializarGradeVoxel(int tamanho)
+// Refaz a lista de instâncias da octree quando a grade ou a câmera mudaram e envia para a GPU.
+// A escala de tela converte lado / distância em pixels: altura / (2 tan(fov / 2)).
+void atualizarLOD()
 {
-    TAM = tamanho;
+    if (octreeSuja)
+    {
+        octree.construir(grade);
+        octreeSuja = false;
+        lodSujo = true;
+    }
+    if (!lodSujo && cameraPos == lodCameraPos && cameraFront == lodCameraFront && fov == lodFov)
+        return;
+    lodSujo = false;
+    lodCameraPos = cameraPos;
+    lodCameraFront = cameraFront;
+    lodFov = fov;
+
+    float escalaTela = (float)glm::max(alvosOIT.altura, 1) / (2.0f * std::tan(glm::radians(fov) * 0.5f));
+    instanciasLOD.clear();
+    octree.selecionarLOD(grade, frustum, cameraPos, escalaTela, limiarLOD, [](glm::vec3 centro, int lado, uint8_t cor)
+    {
+        // cubos maiores mantêm a mesma fresta entre vizinhos dos voxels individuais
+        float escala = (float)lado - (1.0f - FATOR_ESCALA_VOXEL);
+        instanciasLOD.push_back({glm::vec4(centro, escala), (uint32_t)cor});
+    });
+
+    GLsizeiptr tamanho = instanciasLOD.size() * sizeof(InstanciaVoxel);
+    glBindBuffer(GL_ARRAY_BUFFER, lodVBO);
+    glBufferData(GL_ARRAY_BUFFER, tamanho, instanciasLOD.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    bytesEnviadosFrame += tamanho;
+}
+
+// Manda os chunks sujos para a fila de malhas e envia para a GPU as malhas que ficaram prontas,
+// até o orçamento do frame; as que sobram ficam para os próximos frames
+void atualizarMalhas()
+{
+    // índices de cor translúcidos não escondem as faces dos vizinhos
+    uint32_t mascaraTranslucidas = 0;
+    for (int i = 0; i < 10; i++)
+        if (colorList[i].a < 1.0f)
+            mascaraTranslucidas |= 1u << i;
+
+    // o voxel de índice i fica centrado em i - TAM / 2, então o canto 0 da grade está meio voxel antes
+    glm::vec3 origem(-(float)(TAM / 2) - 0.5f);
+
+    filaMalhas.definirCamera(cameraPos);
+    for (auto it = chunksMalha.begin(); it != chunksMalha.end();)
+    {
+        ChunkGL &c = it->second;
+        if (!c.sujo || c.emFila)
+        {
+            ++it;
+            continue;
+        }
 
-    // Aloca a matriz
-    grid = new Voxel **[TAM];
-    for (int y = 0; y < TAM; y++)
+        // o chunk esvaziou (ou nunca existiu na grade): a malha é descartada
+        auto chunkGrade = grade.chunks.find(it->first);
+        if (chunkGrade == grade.chunks.end())
+        {
+            liberarChunkMalha(c);
+            it = chunksMalha.erase(it);
+            continue;
+        }
+
+        const ChunkVoxel &cv = *chunkGrade->second;
+        TrabalhoMalha t;
+        t.chave = it->first;
+        t.geracao = geracaoMalhas;
+        t.centro = origem + (glm::vec3((float)cv.cx, (float)cv.cy, (float)cv.cz) + 0.5f) * (float)TAM_CHUNK;
+        t.vizinhanca.reset(new VizinhancaChunk());
+        capturarVizinhanca(grade, cv, *t.vizinhanca);
+        t.tam = TAM;
+        t.origem = origem;
+        t.guloso = malhaGulosa;
+        t.mascaraTranslucidas = mascaraTranslucidas;
+        filaMalhas.enviar(std::move(t));
+
+        c.sujo = false;
+        c.emFila = true;
+        ++it;
+    }
+
+    malhasRecebidas.clear();
+    filaMalhas.receber(ORCAMENTO_MALHAS_POR_FRAME, malhasRecebidas);
+    for (const MalhaPronta &m : malhasRecebidas)
     {
-        grid[y] = new Voxel *[TAM];
-        for (int x = 0; x < TAM; x++)
+        auto it = chunksMalha.find(m.chave);
+        if (m.geracao != geracaoMalhas || it == chunksMalha.end())
+            continue;
+        ChunkGL &c = it->second;
+        c.emFila = false;
+
+        if (c.VAO == 0)
         {
-            grid[y][x] = new Voxel[TAM];
+            glGenVertexArrays(1, &c.VAO);
+            glGenBuffers(1, &c.VBO);
+            glBindVertexArray(c.VAO);
+            glBindBuffer(GL_ARRAY_BUFFER, c.VBO);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(VerticeMalha), (GLvoid *)offsetof(VerticeMalha, pos));
+            glEnableVertexAttribArray(0);
+            glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, sizeof(VerticeMalha), (GLvoid *)offsetof(VerticeMalha, cor));
+            glEnableVertexAttribArray(1);
+            glBindVertexArray(0);
         }
+
+        glBindBuffer(GL_ARRAY_BUFFER, c.VBO);
+        glBufferData(GL_ARRAY_BUFFER, m.vertices.size() * sizeof(VerticeMalha), m.vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        bytesEnviadosFrame += m.vertices.size() * sizeof(VerticeMalha);
+        c.nVertices = (GLsizei)m.vertices.size();
+    }
+    profundidadeFilaMalhas = filaMalhas.profundidade();
+}
+
+// Monta o título com as estatísticas e, se houver, o andamento da tarefa de arquivo.
+// Só chama glfwSetWindowTitle quando algo mudou.
+char textoEstatisticas[384] = "Editor de Voxels";
+int ultimoProgresso = -1;
+
+void atualizarTitulo(bool forcar)
+{
+    int progresso = tarefaArquivo ? (int)(100.0f * tarefaArquivo->progresso) : -1;
+    if (!forcar && progresso == ultimoProgresso)
+        return;
+    ultimoProgresso = progresso;
+
+    char titulo[480];
+    if (progresso >= 0)
+        snprintf(titulo, sizeof(titulo), "%s | %s %d%%", textoEstatisticas, tarefaArquivo->descricao.c_str(), progresso);
+    else
+        snprintf(titulo, sizeof(titulo), "%s", textoEstatisticas);
+    glfwSetWindowTitle(window, titulo);
+}
+
+// Acumula o tempo de frame e, a cada segundo, mostra a média e os draw calls no título da janela
+void atualizarEstatisticas(double tempoFrame, double tempoCPU)
+{
+    framesAmostrados++;
+    tempoAmostrado += tempoFrame;
+    tempoCPUAmostrado += tempoCPU;
+    bytesEnviadosAmostrados += bytesEnviadosFrame;
+    picoBytesEnviados = glm::max(picoBytesEnviados, bytesEnviadosFrame);
+
+    if (tempoAmostrado >= 1.0)
+    {
+        snprintf(textoEstatisticas, sizeof(textoEstatisticas), "Editor de Voxels - %s%s | chunks: %d enviados, %d descartados | %d draw calls | %lld triângulos | upload %lld B/frame (pico %lld B) | fila de malhas %zu | %.2f ms/frame (CPU %.2f ms)",
+                 NOMES_MODO[modoRender], (modoRender == RENDER_MALHA && malhaGulosa) ? " gulosa" : "",
+                 chunksEnviados, chunksDescartados, drawCallsFrame, triangulosFrame,
+                 bytesEnviadosAmostrados / framesAmostrados, picoBytesEnviados, profundidadeFilaMalhas,
+                 1000.0 * tempoAmostrado / framesAmostrados, 1000.0 * tempoCPUAmostrado / framesAmostrados);
+        atualizarTitulo(true);
+
+        framesAmostrados = 0;
+        tempoAmostrado = tempoCPUAmostrado = 0.0;
+        bytesEnviadosAmostrados = picoBytesEnviados = 0;
+    }
+}
+
+void setColor(glm::vec4 cor)
+{
+    glUniform4f(locCor, cor.r, cor.g, cor.b, cor.a);
+}
+
+// Caixas dos chunks do passo, em SoA, e os índices das que passaram no frustum
+CaixasSoA caixasChunks;
+std::vector<uint32_t> chunksVisiveis;
+
+// Listas indexáveis dos chunks a recortar nos modos malha e imediato (as tabelas são hash)
+std::vector<const std::pair<const uint64_t, ChunkGL> *> malhasDesenhaveis;
+std::vector<const ChunkVoxel *> chunksDesenhaveis;
+
+// Testa n chunks de uma vez contra o frustum do frame (8 por iteração com AVX2, ver
+// FrustumLote.h); coordenada(i) devolve o chunk i. Devolve os índices dos visíveis em ordem
+// crescente e atualiza os contadores de culling.
+template <typename Fn>
+const std::vector<uint32_t> &recortarChunks(size_t n, Fn coordenada)
+{
+    // mesmo referencial das malhas: o canto 0 da grade fica meio voxel antes do primeiro centro
+    glm::vec3 origem(-(float)(TAM / 2) - 0.5f);
+    caixasChunks.limpar();
+    for (size_t i = 0; i < n; i++)
+    {
+        glm::vec3 minimo = origem + glm::vec3(coordenada(i) * TAM_CHUNK);
+        caixasChunks.adicionar(minimo, minimo + glm::vec3((float)TAM_CHUNK));
+    }
+
+    chunksVisiveis.resize(n);
+    chunksVisiveis.resize(recortarCaixas(frustum, caixasChunks, chunksVisiveis.data()));
+    if (passoAtual == PASSO_OPACO)
+    {
+        chunksEnviados += (int)chunksVisiveis.size();
+        chunksDescartados += (int)(n - chunksVisiveis.size());
+    }
+    return chunksVisiveis;
+}
+
+// Desenha as instâncias [primeira, primeira + quantidade) apontando os atributos para o início da faixa
+// (glDrawArraysInstancedBaseInstance é do OpenGL 4.2, acima da versão carregada pela GLAD)
+void desenharFaixaInstancias(GLint primeira, GLsizei quantidade)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, instVBO);
+    GLsizeiptr base = (GLsizeiptr)primeira * sizeof(InstanciaVoxel);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(InstanciaVoxel), (GLvoid *)(base + offsetof(InstanciaVoxel, posEscala)));
+    glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, sizeof(InstanciaVoxel), (GLvoid *)(base + offsetof(InstanciaVoxel, dados)));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 36, quantidade);
+    drawCallsFrame++;
+}
+
+// A cor vai para a passada opaca ou para a translúcida conforme o alfa
+bool corNoPasso(const glm::vec4 &cor, PassoOIT passo)
+{
+    return (cor.a < 1.0f) == (passo == PASSO_TRANSLUCIDO);
+}
+
+// A seleção não faz parte da grade: é desenhada por cima, um pouco maior que o voxel
+void desenharSelecao(PassoOIT passo)
+{
+    Voxel sel = grade.ler(selecaoX, selecaoY, selecaoZ);
+    glm::vec4 cor = colorList[sel.corPos] + 0.3f;
+    if (!corNoPasso(cor, passo))
+        return;
+
+    glm::vec3 posSel = grade.posicao(selecaoX, selecaoY, selecaoZ);
+    glUseProgram(shaderID);
+    glBindVertexArray(VAO);
+    setColor(cor);
+    transformaObjeto(posSel.x, posSel.y, posSel.z, 0.0f, 0.0f, 0.0f, 1.02f, 1.02f, 1.02f);
+    glDrawArrays(GL_TRIANGLES, 0, 36);
+    drawCallsFrame++;
+    if (passo == PASSO_OPACO)
+        triangulosFrame += 12;
+}
+
+// Cria (ou recria, ao redimensionar a janela) a cena fora da tela e os alvos de acumulação
+void criarAlvosOIT(int largura, int altura)
+{
+    if (largura <= 0 || altura <= 0)
+        return; // janela minimizada: mantém os alvos atuais
+
+    AlvosOIT &a = alvosOIT;
+    if (a.fboCena)
+    {
+        glDeleteFramebuffers(1, &a.fboCena);
+        glDeleteFramebuffers(1, &a.fboOIT);
+        glDeleteTextures(1, &a.texCena);
+        glDeleteTextures(1, &a.texAcumulo);
+        glDeleteTextures(1, &a.texRevelacao);
+        glDeleteRenderbuffers(1, &a.rboProfundidade);
+    }
+    a.largura = largura;
+    a.altura = altura;
+
+    auto criarTextura = [&](GLint formatoInterno, GLenum formato, GLenum tipo)
+    {
+        GLuint tex;
+        glGenTextures(1, &tex);
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glTexImage2D(GL_TEXTURE_2D, 0, formatoInterno, largura, altura, 0, formato, tipo, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        return tex;
+    };
+    a.texCena = criarTextura(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+    a.texAcumulo = criarTextura(GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT);
+    a.texRevelacao = criarTextura(GL_R8, GL_RED, GL_UNSIGNED_BYTE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenRenderbuffers(1, &a.rboProfundidade);
+    glBindRenderbuffer(GL_RENDERBUFFER, a.rboProfundidade);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, largura, altura);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    // a profundidade é a mesma nos dois: os translúcidos são testados contra os opacos
+    glGenFramebuffers(1, &a.fboCena);
+    glBindFramebuffer(GL_FRAMEBUFFER, a.fboCena);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, a.texCena, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, a.rboProfundidade);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        cout << "Framebuffer da cena incompleto" << endl;
+
+    glGenFramebuffers(1, &a.fboOIT);
+    glBindFramebuffer(GL_FRAMEBUFFER, a.fboOIT);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, a.texAcumulo, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, a.texRevelacao, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, a.rboProfundidade);
+    const GLenum alvos[2] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+    glDrawBuffers(2, alvos);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        cout << "Framebuffer de transparência incompleto" << endl;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// Informa a passada aos três programas da grade
+void definirPassoOIT(PassoOIT passo)
+{
+    passoAtual = passo;
+    glUseProgram(shaderID);
+    glUniform1i(locPassoCor, passo);
+    glUseProgram(shaderInstID);
+    glUniform1i(locPassoInst, passo);
+    glUseProgram(shaderMalhaID);
+    glUniform1i(locPassoMalha, passo);
+}
+
+// Desenha a moldura da grade, a grade no modo atual e a seleção; cada elemento só aparece
+// na passada que corresponde ao seu alfa
+void desenharCena(PassoOIT passo)
+{
+    definirPassoOIT(passo);
+
+    // desenha as linhas do cubo
+    glm::vec4 corMoldura(1.0f, 1.0f, 1.0f, 0.2f); // branco
+    if (corNoPasso(corMoldura, passo))
+    {
+        glUseProgram(shaderID);
+        glBindVertexArray(wireVAO);
+        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+        setColor(corMoldura);
+        transformaObjeto(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, TAM, TAM, TAM);
+        glDrawArrays(GL_LINES, 0, 24);
+        drawCallsFrame++;
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
     }
 
-    // Preenche os valores padrão
-    for (int y = 0, yPos = -TAM / 2; y < TAM; y++, yPos += 1.0f)
+    if (modoRender == RENDER_INSTANCIADO)
     {
-        for (int x = 0, xPos = -TAM / 2; x < TAM; x++, xPos += 1.0f)
+        // segmentos consecutivos de chunks visíveis viram um único draw call (as vagas livres
+        // entre eles têm escala 0 e não geram pixels); com a grade inteira à vista, é um
+        // draw call para a grade toda
+        glUseProgram(shaderInstID);
+        glBindVertexArray(instVAO);
+
+        const std::vector<const SegmentoInstancias *> &segmentos = instancias.segmentosEmOrdem();
+        const std::vector<uint32_t> &visiveis = recortarChunks(segmentos.size(), [&](size_t i)
+        {
+            return glm::ivec3(segmentos[i]->cx, segmentos[i]->cy, segmentos[i]->cz);
+        });
+
+        // um segmento descartado entre dois visíveis (índices não consecutivos) quebra a faixa
+        GLint inicioFaixa = 0, fimFaixa = -1;
+        uint32_t anterior = 0;
+        for (uint32_t i : visiveis)
         {
-            for (int z = 0, zPos = -TAM / 2; z < TAM; z++, zPos += 1.0f)
+            const SegmentoInstancias *seg = segmentos[i];
+            if (fimFaixa >= 0 && i != anterior + 1)
             {
-                grid[y][x][z].pos = glm::vec3(xPos, yPos, zPos);
-                grid[y][x][z].corPos = 0;
-                grid[y][x][z].fatorEscala = 0.98f;
-                grid[y][x][z].visivel = false;
-                grid[y][x][z].selecionado = false;
+                desenharFaixaInstancias(inicioFaixa, fimFaixa - inicioFaixa);
+                fimFaixa = -1;
             }
+            if (fimFaixa < 0)
+                inicioFaixa = (GLint)seg->inicio;
+            fimFaixa = (GLint)(seg->inicio + seg->quantidade);
+            anterior = i;
+            if (passo == PASSO_OPACO)
+                triangulosFrame += 12 * (long long)seg->quantidade;
         }
+        if (fimFaixa >= 0)
+            desenharFaixaInstancias(inicioFaixa, fimFaixa - inicioFaixa);
     }
+    else if (modoRender == RENDER_MALHA)
+    {
+        glUseProgram(shaderMalhaID);
+        malhasDesenhaveis.clear();
+        for (const auto &par : chunksMalha)
+            if (par.second.nVertices > 0)
+                malhasDesenhaveis.push_back(&par);
+        const std::vector<uint32_t> &visiveis = recortarChunks(malhasDesenhaveis.size(), [](size_t i)
+        {
+            uint64_t chave = malhasDesenhaveis[i]->first;
+            return glm::ivec3((int)(chave >> 42), (int)((chave >> 21) & 0x1FFFFF), (int)(chave & 0x1FFFFF));
+        });
+        for (uint32_t i : visiveis)
+        {
+            const ChunkGL &c = malhasDesenhaveis[i]->second;
+            glBindVertexArray(c.VAO);
+            glDrawArrays(GL_TRIANGLES, 0, c.nVertices);
+            drawCallsFrame++;
+            if (passo == PASSO_OPACO)
+                triangulosFrame += c.nVertices / 3;
+        }
+    }
+    else if (modoRender == RENDER_OCTREE)
+    {
+        // a lista já saiu recortada pelo frustum, com a profundidade escolhida por região
+        if (!instanciasLOD.empty())
+        {
+            glUseProgram(shaderInstID);
+            glBindVertexArray(lodVAO);
+            glDrawArraysInstanced(GL_TRIANGLES, 0, 36, (GLsizei)instanciasLOD.size());
+            drawCallsFrame++;
+            if (passo == PASSO_OPACO)
+                triangulosFrame += 12 * (long long)instanciasLOD.size();
+        }
+    }
+    else
+    {
+        // navega só pelos voxels visíveis dos chunks existentes que estão dentro do frustum
+        glUseProgram(shaderID);
+        glBindVertexArray(VAO);
+        chunksDesenhaveis.clear();
+        for (const auto &par : grade.chunks)
+            chunksDesenhaveis.push_back(par.second.get());
+        const std::vector<uint32_t> &visiveis = recortarChunks(chunksDesenhaveis.size(), [](size_t i)
+        {
+            return glm::ivec3(chunksDesenhaveis[i]->cx, chunksDesenhaveis[i]->cy, chunksDesenhaveis[i]->cz);
+        });
+        for (uint32_t i : visiveis)
+        {
+            const ChunkVoxel &c = *chunksDesenhaveis[i];
+            GradeVoxel::paraCadaVoxelDoChunk(c, [passo](int x, int y, int z, const Voxel &v)
+            {
+                if (!corNoPasso(colorList[v.corPos], passo))
+                    return;
+                setColor(colorList[v.corPos]);
+                float fatorEscala = FATOR_ESCALA_VOXEL;
+                glm::vec3 pos = grade.posicao(x, y, z);
+                transformaObjeto(pos.x, pos.y, pos.z, 0.0f, 0.0f, 0.0f, fatorEscala, fatorEscala, fatorEscala);
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+                drawCallsFrame++;
+                triangulosFrame += 12;
+            });
+        }
+    }
+
+    desenharSelecao(passo);
 }
 
-// Função principal da aplicação
-int main()
+// Renderiza o frame: opacos na cena, translúcidos na acumulação, composição e cópia para a janela
+void renderizarFrame()
+{
+    AlvosOIT &a = alvosOIT;
+
+    // opacos: escrevem cor e profundidade, sem mistura
+    glBindFramebuffer(GL_FRAMEBUFFER, a.fboCena);
+    glClearColor(0.09f, 0.09f, 0.09f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glEnable(GL_DEPTH_TEST);
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+    desenharCena(PASSO_OPACO);
+
+    // translúcidos: testam a profundidade dos opacos sem escrevê-la; o acúmulo soma e a
+    // revelação multiplica (1 - alfa) de cada camada
+    glBindFramebuffer(GL_FRAMEBUFFER, a.fboOIT);
+    const GLfloat zeros[4] = {0.0f, 0.0f, 0.0f, 0.0f}, um[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    glClearBufferfv(GL_COLOR, 0, zeros);
+    glClearBufferfv(GL_COLOR, 1, um);
+    glDepthMask(GL_FALSE);
+    glEnable(GL_BLEND);
+    glBlendFunci(0, GL_ONE, GL_ONE);
+    glBlendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+    desenharCena(PASSO_TRANSLUCIDO);
+
+    // composição sobre a cena opaca
+    glBindFramebuffer(GL_FRAMEBUFFER, a.fboCena);
+    glDisable(GL_DEPTH_TEST);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    programaComposicao.usar();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, a.texAcumulo);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, a.texRevelacao);
+    glBindVertexArray(composicaoVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    drawCallsFrame++;
+    glActiveTexture(GL_TEXTURE0);
+
+    glDepthMask(GL_TRUE);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, a.fboCena);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, a.largura, a.altura, 0, 0, a.largura, a.altura, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// Envia a paleta para os shaders que leem a cor pelo índice
+void enviarPaleta()
+{
+    programaInst.usar();
+    glUniform4fv(programaInst.uniform("uPaleta"), 10, glm::value_ptr(colorList[0]));
+    programaMalha.usar();
+    glUniform4fv(programaMalha.uniform("uPaleta"), 10, glm::value_ptr(colorList[0]));
+}
+
+// inicializa a grid
+void inicializarGradeVoxel(int tamanho)
+{
+    TAM = tamanho;
+
+    // um único bloco para a grade inteira, todos os voxels começam invisíveis e cinzas
+    grade.redimensionar(TAM);
+}
+
+// Zera os contadores do frame, envia a câmera e os dados do modo atual e desenha as passadas
+void executarFrame()
+{
+    drawCallsFrame = 0;
+    triangulosFrame = 0;
+    bytesEnviadosFrame = 0;
+    chunksEnviados = chunksDescartados = 0;
+
+    // view e projeção vão uma única vez para o bloco de câmera, lido pelos três programas
+    atualizarCamera();
+
+    // os dados da grade vão para a GPU antes das passadas, que os desenham duas vezes
+    if (modoRender == RENDER_INSTANCIADO)
+        atualizarInstancias();
+    else if (modoRender == RENDER_MALHA)
+        atualizarMalhas();
+    else if (modoRender == RENDER_OCTREE)
+        atualizarLOD();
+
+    renderizarFrame();
+}
+
+void aplicarPose(const PoseCamera &p)
+{
+    cameraPos = p.posicao;
+    cameraFront = glm::normalize(p.frente);
+    fov = p.fov;
+    glm::vec3 right = glm::normalize(glm::cross(cameraFront, glm::vec3(0.0, 1.0, 0.0)));
+    cameraUp = glm::normalize(glm::cross(right, cameraFront));
+}
+
+// Modo de benchmark (ver BenchmarkVoxel.h): carrega a grade, percorre o caminho de câmera e
+// imprime as medidas em JSON. Cada frame termina com glFinish, para que o tempo inclua o
+// trabalho da GPU e não só a submissão dos comandos.
+int executarBenchmark(const OpcoesBenchmark &opcoes)
+{
+    int modo = -1;
+    for (int i = 0; i < 4; i++)
+        if (opcoes.modo == NOMES_MODO[i])
+            modo = i;
+    if (modo < 0)
+    {
+        std::cerr << "Modo desconhecido: " << opcoes.modo << "\n";
+        return 1;
+    }
+    modoRender = (ModoRender)modo;
+
+    std::vector<PoseCamera> poses;
+    if (!opcoes.caminho.empty() && !carregarCaminho(opcoes.caminho, poses))
+    {
+        std::cerr << "Não foi possível ler o caminho " << opcoes.caminho << "\n";
+        return 1;
+    }
+
+    // a leitura é síncrona aqui: não há editor para manter respondendo
+    TarefaArquivo t;
+    t.carregamento = true;
+    t.selecao = glm::ivec3(selecaoX, selecaoY, selecaoZ);
+    auto extensao = [&](const char *ext)
+    {
+        return opcoes.arquivo.size() > 4 && opcoes.arquivo.compare(opcoes.arquivo.size() - 4, 4, ext) == 0;
+    };
+    bool ok = extensao(".txt")   ? carregarGradeTexto(t.grade, opcoes.arquivo, t.selecao)
+              : extensao(".vox") ? carregarGradeVox(t.grade, opcoes.arquivo, colorList, 10)
+                                 : carregarGradeBinaria(t.grade, opcoes.arquivo, &t.paleta);
+    if (!ok)
+    {
+        std::cerr << "Não foi possível carregar " << opcoes.arquivo << "\n";
+        return 1;
+    }
+    aplicarGradeLida(t);
+
+    size_t voxels = grade.contarOcupados();
+
+    MedidasBenchmark medidas;
+    int total = opcoes.aquecimento + opcoes.frames;
+    for (int frame = 0; frame < total && !glfwWindowShouldClose(window); frame++)
+    {
+        // o aquecimento repete a primeira pose; o caminho gravado se repete se for mais curto
+        int i = glm::max(frame - opcoes.aquecimento, 0);
+        aplicarPose(poses.empty() ? poseOrbita(i, opcoes.frames, TAM) : poses[i % poses.size()]);
+
+        double inicio = glfwGetTime();
+        executarFrame();
+        double tempoCPU = glfwGetTime() - inicio;
+        glfwSwapBuffers(window);
+        glFinish();
+        double tempoFrame = glfwGetTime() - inicio;
+        glfwPollEvents();
+
+        if (frame < opcoes.aquecimento)
+            continue;
+        medidas.tempoFrameMs.push_back(1000.0 * tempoFrame);
+        medidas.tempoCPUMs.push_back(1000.0 * tempoCPU);
+        medidas.drawCalls.push_back((double)drawCallsFrame);
+        medidas.triangulos.push_back((double)triangulosFrame);
+        medidas.bytesEnviados.push_back((double)bytesEnviadosFrame);
+        medidas.filaMalhas.push_back((double)profundidadeFilaMalhas);
+    }
+
+    const GLubyte *renderer = glGetString(GL_RENDERER);
+    imprimirBenchmarkJSON(std::cout, opcoes, renderer ? (const char *)renderer : "", TAM, voxels, medidas);
+    return 0;
+}
+
+// Lista de comandos, impressa no console ao abrir o editor
+void imprimirAjuda()
 {
-    #ifdef _WIN32
-    SetConsoleOutputCP(CP_UTF8);
-    SetConsoleCP(CP_UTF8);
-    #endif
-    glfwInit();
-    window = glfwCreateWindow(WIDTH, HEIGHT, "Editor de Voxels", nullptr, nullptr);
     std::cout << "================= EDITOR DE VOXELS =================\n";
     std::cout << ">> Movimentos:\n";
     std::cout << "   W / A / S / D : mover\n";
@@ -554,43 +1778,128 @@ int main()
     std::cout << "   SETAS         : mover voxel selecionado\n";
     std::cout << "   Q / E         : mover na profundidade\n";
     std::cout << "   DELETE        : apagar voxel\n";
-    std::cout << "   Números (1-0) : escolher cor\n\n";
+    std::cout << "   Números (1-0) : escolher cor\n";
+    std::cout << "   Clique esq.   : selecionar voxel sob o cursor (centro da tela com o cursor preso)\n";
+    std::cout << "   SHIFT + clique: selecionar a célula vazia ao lado da face clicada\n";
+    std::cout << "   CTRL + Z      : desfazer\n";
+    std::cout << "   CTRL + Y      : refazer (ou CTRL + SHIFT + Z)\n\n";
+
+    std::cout << ">> Edição em massa (cor atual = última tecla 1-0):\n";
+    std::cout << "   M             : marcar âncora na seleção\n";
+    std::cout << "   B / SHIFT + B : preencher / apagar caixa da âncora até a seleção\n";
+    std::cout << "   O / SHIFT + O : preencher / apagar esfera centrada na âncora até a seleção\n";
+    std::cout << "   R             : trocar a cor do voxel selecionado pela atual na grade toda\n";
+    std::cout << "   F             : inundar a partir da seleção com a cor atual\n\n";
 
     std::cout << ">> Salvamento:\n";
-    std::cout << "   F1            : salvar cena\n";
-    std::cout << "   F2            : carregar cena\n\n";
+    std::cout << "   F1            : salvar cena (binário)\n";
+    std::cout << "   F2            : carregar cena (binário)\n";
+    std::cout << "   F5            : exportar cena em texto\n";
+    std::cout << "   F6            : importar cena em texto\n";
+    std::cout << "   F8            : importar modelo do MagicaVoxel (modelo.vox)\n";
+    std::cout << "   F9 / F10      : exportar malha em OBJ / glTF binário (minecraft.obj / .glb)\n\n";
+
+    std::cout << ">> Renderização:\n";
+    std::cout << "   F3            : alternar modo imediato / instanciado / malha / octree\n";
+    std::cout << "   F4            : ligar / desligar união de faces da malha\n";
+    std::cout << "   [ / ]         : mais / menos detalhe no modo octree\n";
+    std::cout << "   F7            : gravar / parar de gravar o caminho da câmera (caminho.txt)\n\n";
 
     std::cout << ">> Outros:\n";
     std::cout << "   ESC           : mostrar cursor\n";
+    std::cout << "   GB --benchmark arquivo.voxb [--frames N] [--modo nome] [--caminho caminho.txt]\n";
     std::cout << "====================================================\n\n";
+}
+
+// Função principal da aplicação
+int main(int argc, char **argv)
+{
+    #ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+    SetConsoleCP(CP_UTF8);
+    #endif
+    OpcoesBenchmark benchmark;
+    if (!lerOpcoesBenchmark(argc, argv, benchmark))
+        return 1;
+
+    glfwInit();
+    if (benchmark.ativo)
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE); // o benchmark não precisa mostrar a janela
+    window = glfwCreateWindow(WIDTH, HEIGHT, "Editor de Voxels", nullptr, nullptr);
+    if (!window)
+    {
+        std::cerr << "Não foi possível criar a janela OpenGL\n";
+        glfwTerminate();
+        return 1;
+    }
+    if (!benchmark.ativo)
+        imprimirAjuda();
     glfwMakeContextCurrent(window);
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
     glfwSetCursorPosCallback(window, mouse_callback);
     glfwSetScrollCallback(window, scroll_callback);
+    glfwSetMouseButtonCallback(window, mouse_button_callback);
     glfwSetKeyCallback(window, key_callback);
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    if (!benchmark.ativo)
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
     gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
-
-    shaderID = setupShader();
+    if (benchmark.ativo)
+        glfwSwapInterval(0); // sem vsync: o tempo medido é o do frame, não o da tela
+
+    programaCor.compilar(vertexShaderSource, fragmentShaderOITSource);
+    programaInst.compilar(vertexShaderInstSource, fragmentShaderOITSource);
+    programaMalha.compilar(vertexShaderMalhaSource, fragmentShaderOITSource);
+    shaderID = programaCor.id;
+    shaderInstID = programaInst.id;
+    shaderMalhaID = programaMalha.id;
+    locModel = programaCor.uniform("model");
+    locCor = programaCor.uniform("uColor");
+    locPassoCor = programaCor.uniform("uPassoOIT");
+    locPassoInst = programaInst.uniform("uPassoOIT");
+    locPassoMalha = programaMalha.uniform("uPassoOIT");
+    blocoCamera.criar();
+
+    programaComposicao.compilar(vertexShaderComposicaoSource, fragmentShaderComposicaoSource);
+    programaComposicao.usar();
+    glUniform1i(programaComposicao.uniform("uAcumulo"), 0);
+    glUniform1i(programaComposicao.uniform("uRevelacao"), 1);
+    glGenVertexArrays(1, &composicaoVAO); // o triângulo de tela sai de gl_VertexID, sem atributos
+
+    int larguraFB, alturaFB;
+    glfwGetFramebufferSize(window, &larguraFB, &alturaFB);
+    criarAlvosOIT(larguraFB, alturaFB);
     VAO = setupGeometry();
     wireVAO = setupWireframeCube();
+    instVAO = setupGeometriaInstanciada(instVBO);
+    lodVAO = setupGeometriaInstanciada(lodVBO);
+
+    // a paleta só muda ao carregar um arquivo, então não é enviada a cada frame
+    enviarPaleta();
 
     glEnable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     float xPos, yPos, zPos;
 
-    //inicializo a matriz tridimensional de voxels, todos invisíveis
-    inicializarGradeVoxel(25);
+    //inicializo a grade de voxels, todos invisíveis; só os chunks editados ocupam memória
+    inicializarGradeVoxel(1024);
+    inicializarChunksMalha();
 
-    //defino o bloco inicialmente selecionado
-    selecaoX = 0;
-    selecaoY = 0;
-    selecaoZ = TAM - 1;
+    //defino o bloco inicialmente selecionado, no centro da grade
+    selecaoX = TAM / 2;
+    selecaoY = TAM / 2;
+    selecaoZ = TAM / 2;
+    ancoraX = selecaoX;
+    ancoraY = selecaoY;
+    ancoraZ = selecaoZ;
 
-    grid[selecaoY][selecaoX][selecaoZ].selecionado = true;
+    if (benchmark.ativo)
+    {
+        int resultado = executarBenchmark(benchmark);
+        blocoCamera.destruir();
+        glfwTerminate();
+        return resultado;
+    }
 
     while (!glfwWindowShouldClose(window))
     {
@@ -599,57 +1908,28 @@ int main()
         lastFrame = currentFrame;
 
         processInput(window);
+        verificarTarefaArquivo();
 
-        glClearColor(0.09f, 0.09f, 0.09f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        glUseProgram(shaderID);
+        if (gravacaoCaminho.is_open())
+            gravarPose(gravacaoCaminho, {cameraPos, cameraFront, fov});
 
-        especificaVisualizacao();
-        especificaProjecao();
+        double inicioCPU = glfwGetTime();
+        executarFrame();
 
-        // renderizar os objetos
-        glBindVertexArray(VAO);
-
-        // desenha as linhas do cubo
-        glBindVertexArray(wireVAO);
-        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-        setColor(shaderID, glm::vec4(1.0f, 1.0f, 1.0f, 0.2f)); // branco
-        transformaObjeto(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, TAM, TAM, TAM);
-        glDrawArrays(GL_LINES, 0, 24);
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-        glBindVertexArray(VAO);
-
-        // navega na grid tridimensional pelos seus índices
-        for (int x = 0; x < TAM; x++)
-        {
-            for (int y = 0; y < TAM; y++)
-            {
-                for (int z = 0; z < TAM; z++)
-                {
-                    if (grid[y][x][z].selecionado)
-                    { // se estiver selecionado, da um brilho no objeto
-                        setColor(shaderID, colorList[grid[y][x][z].corPos] + 0.3f);
-                    }
-                    else
-                    {
-                        setColor(shaderID, colorList[grid[y][x][z].corPos]);
-                    }
-                    // se for um voxel visivel
-                    if (grid[y][x][z].visivel || grid[y][x][z].selecionado)
-                    {
-                        float fatorEscala = grid[y][x][z].fatorEscala;
-                        transformaObjeto(grid[y][x][z].pos.x, grid[y][x][z].pos.y, grid[y][x][z].pos.z, 0.0f, 0.0f, 0.0f, fatorEscala, fatorEscala, fatorEscala);
-                        glDrawArrays(GL_TRIANGLES, 0, 36);
-                    }
-                }
-            }
-        }
+        double tempoCPU = glfwGetTime() - inicioCPU;
         glfwSwapBuffers(window);
         glfwPollEvents();
+
+        atualizarEstatisticas(deltaTime, tempoCPU);
+        atualizarTitulo(false);
     }
 
+    // uma gravação em andamento precisa terminar antes de sair
+    if (tarefaArquivo)
+        tarefaArquivo->thread.join();
+
     glDeleteVertexArrays(1, &VAO);
+    blocoCamera.destruir();
     glfwTerminate();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,306 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <glm/glm.hpp>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Escala de desenho de cada voxel (deixa uma pequena fresta entre os vizinhos)
+const float FATOR_ESCALA_VOXEL = 0.98f;
+
+// Lado de um chunk, em voxels; também é a unidade de malha e de culling
+const int TAM_CHUNK = 16;
+const int VOXELS_POR_CHUNK = TAM_CHUNK * TAM_CHUNK * TAM_CHUNK;
+
+// Voxel compactado em 2 bytes: o índice da cor na paleta e um campo de flags.
+// A posição e a escala não são guardadas, pois saem do índice na grade.
+struct Voxel
+{
+    uint8_t corPos;
+    uint8_t visivel : 1;
+
+    Voxel() : corPos(0), visivel(0) {}
+};
+
+const int PALAVRAS_OCUPACAO = VOXELS_POR_CHUNK / 64;
+
+// Quantos bits ligados (popcount) e posição do bit ligado mais baixo (ctz; v não pode ser 0)
+inline int contarBits(uint64_t v)
+{
+#ifdef _MSC_VER
+    return (int)__popcnt64(v);
+#else
+    return __builtin_popcountll(v);
+#endif
+}
+
+inline int primeiroBit(uint64_t v)
+{
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanForward64(&i, v);
+    return (int)i;
+#else
+    return __builtin_ctzll(v);
+#endif
+}
+
+// Bloco de TAM_CHUNK³ voxels; x varia mais devagar e z mais rápido.
+// ocupacao guarda o campo visivel de cada voxel em um bit (bit i da palavra i / 64 = voxel i),
+// para que os percursos pulem 64 voxels vazios com uma comparação; todo código que muda a
+// visibilidade de um voxel do chunk precisa manter os dois de acordo.
+struct ChunkVoxel
+{
+    int cx, cy, cz;
+    int ocupados = 0; // quantos voxels visíveis; o chunk é liberado quando chega a zero
+    uint64_t ocupacao[PALAVRAS_OCUPACAO] = {};
+    Voxel voxels[VOXELS_POR_CHUNK];
+
+    bool ocupado(int local) const
+    {
+        return (ocupacao[local >> 6] >> (local & 63)) & 1;
+    }
+
+    void marcar(int local, bool visivel)
+    {
+        uint64_t bit = 1ull << (local & 63);
+        if (visivel)
+            ocupacao[local >> 6] |= bit;
+        else
+            ocupacao[local >> 6] &= ~bit;
+    }
+
+    // Contagem pelo bitmap, em O(palavras)
+    int contarOcupados() const
+    {
+        int n = 0;
+        for (int w = 0; w < PALAVRAS_OCUPACAO; w++)
+            n += contarBits(ocupacao[w]);
+        return n;
+    }
+
+    // Refaz o bitmap a partir dos voxels, depois de alterá-los diretamente
+    void refazerOcupacao()
+    {
+        for (int w = 0; w < PALAVRAS_OCUPACAO; w++)
+        {
+            uint64_t palavra = 0;
+            for (int b = 0; b < 64; b++)
+                palavra |= (uint64_t)voxels[w * 64 + b].visivel << b;
+            ocupacao[w] = palavra;
+        }
+        ocupados = contarOcupados();
+    }
+
+    // Primeiro índice local >= i com o voxel visível (ou vazio, se procurarVazio), ou
+    // VOXELS_POR_CHUNK se não houver
+    int proximo(int i, bool procurarVazio = false) const
+    {
+        for (int w = i >> 6; w < PALAVRAS_OCUPACAO; w++)
+        {
+            uint64_t palavra = procurarVazio ? ~ocupacao[w] : ocupacao[w];
+            if (w == i >> 6)
+                palavra &= ~0ull << (i & 63);
+            if (palavra)
+                return w * 64 + primeiroBit(palavra);
+        }
+        return VOXELS_POR_CHUNK;
+    }
+};
+
+// Grade esparsa tam³: só existem os chunks que têm ao menos um voxel visível.
+// Os chunks ficam em uma tabela hash indexada pela coordenada do chunk, então memória
+// e percursos crescem com a quantidade de chunks ocupados e não com o tamanho da grade.
+// Os chunks são compartilhados com os instantâneos (ver instantaneo()): toda escrita passa por
+// paraEscrita, que copia o chunk antes se outro dono ainda o enxerga.
+struct GradeVoxel
+{
+    int tam = 0;
+    std::unordered_map<uint64_t, std::shared_ptr<ChunkVoxel>> chunks;
+
+    // Descarta o conteúdo atual e define os novos limites
+    void redimensionar(int tamanho)
+    {
+        tam = tamanho;
+        chunks.clear();
+    }
+
+    // 21 bits por eixo cobrem grades de até 2^21 chunks de lado
+    static uint64_t chaveChunk(int cx, int cy, int cz)
+    {
+        return ((uint64_t)cx << 42) | ((uint64_t)cy << 21) | (uint64_t)cz;
+    }
+
+    static int indiceLocal(int lx, int ly, int lz)
+    {
+        return (lx * TAM_CHUNK + ly) * TAM_CHUNK + lz;
+    }
+
+    const ChunkVoxel *chunk(int cx, int cy, int cz) const
+    {
+        auto it = chunks.find(chaveChunk(cx, cy, cz));
+        return it == chunks.end() ? nullptr : it->second.get();
+    }
+
+    bool dentro(int x, int y, int z) const
+    {
+        return x >= 0 && y >= 0 && z >= 0 && x < tam && y < tam && z < tam;
+    }
+
+    // Voxel em (x, y, z); fora da grade ou em chunk inexistente devolve um voxel vazio
+    Voxel ler(int x, int y, int z) const
+    {
+        if (!dentro(x, y, z))
+            return Voxel();
+        const ChunkVoxel *c = chunk(x / TAM_CHUNK, y / TAM_CHUNK, z / TAM_CHUNK);
+        if (!c)
+            return Voxel();
+        return c->voxels[indiceLocal(x % TAM_CHUNK, y % TAM_CHUNK, z % TAM_CHUNK)];
+    }
+
+    // Grava o voxel, criando o chunk na primeira escrita visível e liberando-o quando esvazia.
+    // Devolve false se nada mudou.
+    bool escrever(int x, int y, int z, Voxel v)
+    {
+        if (!dentro(x, y, z))
+            return false;
+
+        int cx = x / TAM_CHUNK, cy = y / TAM_CHUNK, cz = z / TAM_CHUNK;
+        uint64_t chave = chaveChunk(cx, cy, cz);
+        auto it = chunks.find(chave);
+        if (it == chunks.end())
+        {
+            if (!v.visivel)
+                return false; // apagar em chunk inexistente não muda nada
+            it = chunks.emplace(chave, novoChunk(cx, cy, cz)).first;
+        }
+
+        const Voxel &lido = it->second->voxels[indiceLocal(x % TAM_CHUNK, y % TAM_CHUNK, z % TAM_CHUNK)];
+        if (lido.visivel == v.visivel && lido.corPos == v.corPos)
+            return false;
+
+        ChunkVoxel &c = paraEscrita(it->second);
+        Voxel &atual = c.voxels[indiceLocal(x % TAM_CHUNK, y % TAM_CHUNK, z % TAM_CHUNK)];
+        c.ocupados += (int)v.visivel - (int)atual.visivel;
+        atual = v;
+        c.marcar(indiceLocal(x % TAM_CHUNK, y % TAM_CHUNK, z % TAM_CHUNK), v.visivel);
+        if (c.ocupados == 0)
+            chunks.erase(it);
+        return true;
+    }
+
+    // Edição em massa de um chunk com uma única busca na tabela: fn(ChunkVoxel &) altera os
+    // voxels à vontade e o bitmap e a contagem de ocupados são refeitos no fim. O chunk é
+    // criado se não existir e liberado se terminar vazio.
+    template <typename Fn>
+    void editarChunk(int cx, int cy, int cz, Fn fn)
+    {
+        uint64_t chave = chaveChunk(cx, cy, cz);
+        auto it = chunks.find(chave);
+        if (it == chunks.end())
+            it = chunks.emplace(chave, novoChunk(cx, cy, cz)).first;
+
+        ChunkVoxel &c = paraEscrita(it->second);
+        fn(c);
+        c.refazerOcupacao();
+        if (c.ocupados == 0)
+            chunks.erase(it);
+    }
+
+    // Chama fn(local) para o índice local de cada voxel visível de um chunk, em ordem crescente.
+    // Anda pelo bitmap: uma palavra vazia custa uma comparação e cada bit ligado sai com ctz.
+    template <typename Fn>
+    static void paraCadaOcupado(const ChunkVoxel &c, Fn fn)
+    {
+        for (int w = 0; w < PALAVRAS_OCUPACAO; w++)
+        {
+            uint64_t palavra = c.ocupacao[w];
+            while (palavra)
+            {
+                fn(w * 64 + primeiroBit(palavra));
+                palavra &= palavra - 1; // desliga o bit mais baixo
+            }
+        }
+    }
+
+    // Chama fn(x, y, z, voxel) para cada voxel visível de um chunk
+    template <typename Fn>
+    static void paraCadaVoxelDoChunk(const ChunkVoxel &c, Fn fn)
+    {
+        int x0 = c.cx * TAM_CHUNK, y0 = c.cy * TAM_CHUNK, z0 = c.cz * TAM_CHUNK;
+        paraCadaOcupado(c, [&](int i)
+        {
+            fn(x0 + i / (TAM_CHUNK * TAM_CHUNK), y0 + (i / TAM_CHUNK) % TAM_CHUNK, z0 + i % TAM_CHUNK, c.voxels[i]);
+        });
+    }
+
+    // Chama fn(x, y, z, voxel) para cada voxel visível, percorrendo só os chunks existentes
+    template <typename Fn>
+    void paraCadaVoxel(Fn fn) const
+    {
+        for (const auto &par : chunks)
+            paraCadaVoxelDoChunk(*par.second, fn);
+    }
+
+    // Total de voxels visíveis, somando os bitmaps dos chunks
+    size_t contarOcupados() const
+    {
+        size_t n = 0;
+        for (const auto &par : chunks)
+            n += (size_t)par.second->contarOcupados();
+        return n;
+    }
+
+    // Instantâneo para gravar em segundo plano: copia só a tabela, e os chunks passam a ser
+    // compartilhados. Enquanto o instantâneo existir, a primeira escrita em cada chunk o copia
+    // (copy-on-write), então tirar o instantâneo custa uma entrada de tabela por chunk e o
+    // instantâneo não muda. Só a grade original escreve; o instantâneo é só lido.
+    GradeVoxel instantaneo() const
+    {
+        GradeVoxel copia;
+        copia.tam = tam;
+        copia.chunks = chunks;
+        return copia;
+    }
+
+    static std::shared_ptr<ChunkVoxel> novoChunk(int cx, int cy, int cz)
+    {
+        std::shared_ptr<ChunkVoxel> c = std::make_shared<ChunkVoxel>();
+        c->cx = cx;
+        c->cy = cy;
+        c->cz = cz;
+        return c;
+    }
+
+    // O chunk pronto para ser alterado: copiado antes se um instantâneo ainda o compartilha.
+    // Quem mais pode segurá-lo é um instantâneo em outra thread, que só solta a referência;
+    // então, visto um único dono, ninguém mais o lê e nenhum outro dono vai aparecer.
+    static ChunkVoxel &paraEscrita(std::shared_ptr<ChunkVoxel> &c)
+    {
+        if (c.use_count() > 1)
+            c = std::make_shared<ChunkVoxel>(*c);
+        else
+            std::atomic_thread_fence(std::memory_order_acquire); // as leituras do outro dono terminaram
+        return *c;
+    }
+
+    // Posição de mundo do centro do voxel: a grade fica centrada na origem
+    glm::vec3 posicao(int x, int y, int z) const
+    {
+        return glm::vec3((float)(x - tam / 2), (float)(y - tam / 2), (float)(z - tam / 2));
+    }
+
+    // Memória aproximada: os chunks mais a tabela hash
+    size_t bytes() const
+    {
+        return chunks.size() * (sizeof(ChunkVoxel) + sizeof(std::shared_ptr<ChunkVoxel>) + sizeof(uint64_t) + 4 * sizeof(void *)) +
+               chunks.bucket_count() * sizeof(void *);
+    }
+};
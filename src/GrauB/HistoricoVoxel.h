@@ -0,0 +1,192 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+#include "GradeVoxel.h"
+
+// Histórico de desfazer / refazer das edições da grade.
+// Cada operação (um voxel ou uma edição em massa) é guardada como a lista dos voxels que ela
+// mudou, com o valor antes e depois, em vez de uma cópia da grade. Deltas e operações ficam em
+// dois anéis de tamanho fixo, reservados uma única vez a partir do limite de memória: quando
+// enchem, as operações mais antigas são descartadas. Desfazer e refazer custam O(voxels da operação).
+
+// Um voxel alterado: posição e os dois valores (o Voxel tem só cor e visibilidade)
+struct DeltaVoxel
+{
+    uint32_t x, y, z;
+    uint8_t corAntes, corDepois;
+    uint8_t visivelAntes : 1, visivelDepois : 1;
+};
+
+// Operação registrada: faixa [inicio, inicio + quantidade) de deltas, em índices absolutos
+struct OperacaoHistorico
+{
+    uint64_t inicio;
+    uint32_t quantidade;
+};
+
+class HistoricoVoxel
+{
+public:
+    explicit HistoricoVoxel(size_t limiteBytes = 4 << 20)
+    {
+        definirLimite(limiteBytes);
+    }
+
+    // Reserva os anéis dentro do limite (3/4 para deltas, 1/4 para operações) e limpa o histórico
+    void definirLimite(size_t limiteBytes)
+    {
+        deltas.assign(std::max(limiteBytes * 3 / 4 / sizeof(DeltaVoxel), (size_t)1), DeltaVoxel());
+        operacoes.assign(std::max(limiteBytes / 4 / sizeof(OperacaoHistorico), (size_t)2), OperacaoHistorico());
+        limpar();
+    }
+
+    void limpar()
+    {
+        primeiroDelta = fimDelta = inicioAberta = 0;
+        primeiraOp = atualOp = fimOp = 0;
+        profundidade = 0;
+        descartada = false;
+    }
+
+    // Agrupa as edições até o concluir correspondente em uma única operação (pode aninhar)
+    void iniciar()
+    {
+        if (profundidade++ > 0)
+            return;
+
+        // uma edição nova invalida o que podia ser refeito
+        fimOp = atualOp;
+        fimDelta = atualOp > primeiraOp ? fimDaOperacao(atualOp - 1) : primeiroDelta;
+        inicioAberta = fimDelta;
+        descartada = false;
+    }
+
+    void concluir()
+    {
+        if (profundidade == 0 || --profundidade > 0)
+            return;
+        if (descartada || fimDelta == inicioAberta)
+            return;
+
+        if (fimOp - primeiraOp == operacoes.size())
+            descartarMaisAntiga();
+        operacoes[fimOp % operacoes.size()] = {inicioAberta, (uint32_t)(fimDelta - inicioAberta)};
+        fimOp++;
+        atualOp = fimOp;
+    }
+
+    // Registra uma mudança já aplicada na grade; fora de iniciar/concluir vira uma operação sozinha
+    void registrar(int x, int y, int z, Voxel antes, Voxel depois)
+    {
+        bool avulsa = profundidade == 0;
+        if (avulsa)
+            iniciar();
+
+        if (!descartada)
+        {
+            while (fimDelta - primeiroDelta >= deltas.size())
+            {
+                if (primeiraOp == fimOp)
+                {
+                    // a operação aberta sozinha não cabe no limite: ela não poderá ser desfeita
+                    descartada = true;
+                    primeiroDelta = fimDelta = inicioAberta;
+                    break;
+                }
+                descartarMaisAntiga();
+            }
+        }
+        if (!descartada)
+        {
+            DeltaVoxel &d = deltas[fimDelta % deltas.size()];
+            d.x = (uint32_t)x;
+            d.y = (uint32_t)y;
+            d.z = (uint32_t)z;
+            d.corAntes = antes.corPos;
+            d.corDepois = depois.corPos;
+            d.visivelAntes = antes.visivel;
+            d.visivelDepois = depois.visivel;
+            fimDelta++;
+        }
+
+        if (avulsa)
+            concluir();
+    }
+
+    // Desfaz a última operação chamando aplicar(x, y, z, voxel) com os valores antigos,
+    // do último delta para o primeiro. Devolve false se não há o que desfazer.
+    template <typename Fn>
+    bool desfazer(Fn aplicar)
+    {
+        if (profundidade > 0 || atualOp == primeiraOp)
+            return false;
+        atualOp--;
+        const OperacaoHistorico &op = operacoes[atualOp % operacoes.size()];
+        for (uint64_t i = op.inicio + op.quantidade; i-- > op.inicio;)
+        {
+            const DeltaVoxel &d = deltas[i % deltas.size()];
+            aplicar((int)d.x, (int)d.y, (int)d.z, voxel(d.corAntes, d.visivelAntes));
+        }
+        return true;
+    }
+
+    // Refaz a próxima operação desfeita, na ordem original
+    template <typename Fn>
+    bool refazer(Fn aplicar)
+    {
+        if (profundidade > 0 || atualOp == fimOp)
+            return false;
+        const OperacaoHistorico &op = operacoes[atualOp % operacoes.size()];
+        for (uint64_t i = op.inicio; i < op.inicio + op.quantidade; i++)
+        {
+            const DeltaVoxel &d = deltas[i % deltas.size()];
+            aplicar((int)d.x, (int)d.y, (int)d.z, voxel(d.corDepois, d.visivelDepois));
+        }
+        atualOp++;
+        return true;
+    }
+
+    size_t niveisDesfazer() const { return (size_t)(atualOp - primeiraOp); }
+    size_t niveisRefazer() const { return (size_t)(fimOp - atualOp); }
+    size_t deltasGuardados() const { return (size_t)(fimDelta - primeiroDelta); }
+
+    // Memória reservada pelos anéis; não cresce com o uso
+    size_t bytes() const
+    {
+        return deltas.capacity() * sizeof(DeltaVoxel) + operacoes.capacity() * sizeof(OperacaoHistorico);
+    }
+
+private:
+    std::vector<DeltaVoxel> deltas;
+    std::vector<OperacaoHistorico> operacoes;
+    uint64_t primeiroDelta = 0, fimDelta = 0; // deltas válidos em [primeiroDelta, fimDelta)
+    uint64_t inicioAberta = 0;                // primeiro delta da operação em andamento
+    uint64_t primeiraOp = 0, atualOp = 0, fimOp = 0; // desfazíveis em [primeiraOp, atualOp)
+    int profundidade = 0;
+    bool descartada = false; // a operação em andamento estourou o limite
+
+    uint64_t fimDaOperacao(uint64_t i) const
+    {
+        const OperacaoHistorico &op = operacoes[i % operacoes.size()];
+        return op.inicio + op.quantidade;
+    }
+
+    void descartarMaisAntiga()
+    {
+        primeiroDelta = fimDaOperacao(primeiraOp);
+        primeiraOp++;
+        atualOp = std::max(atualOp, primeiraOp);
+    }
+
+    static Voxel voxel(uint8_t cor, uint8_t visivel)
+    {
+        Voxel v;
+        v.corPos = cor;
+        v.visivel = visivel;
+        return v;
+    }
+};
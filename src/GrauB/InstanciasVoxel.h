@@ -0,0 +1,255 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include <glm/glm.hpp>
+
+#include "GradeVoxel.h"
+
+// Espelho em CPU do buffer de instâncias do modo instanciado, atualizado voxel a voxel.
+// Cada chunk ocupa um segmento contíguo do buffer com folga para crescer; editar um voxel
+// muda uma ou duas instâncias e só essas faixas são marcadas para reenvio.
+
+// Dados por instância: posição + escala e o índice da cor na paleta.
+// Escala 0 marca uma vaga livre: o cubo degenera em um ponto e nada é rasterizado.
+struct InstanciaVoxel
+{
+    glm::vec4 posEscala;
+    uint32_t dados;
+};
+
+// Faixas [inicio, fim) de um buffer que precisam ser reenviadas, em unidades de elemento
+struct FaixasSujas
+{
+    std::vector<std::pair<size_t, size_t>> faixas;
+
+    void marcar(size_t inicio, size_t fim)
+    {
+        if (inicio >= fim)
+            return;
+        faixas.push_back({inicio, fim});
+        // muitas edições sem envio (por exemplo, em outro modo de render) não acumulam sem limite
+        if (faixas.size() > 4096)
+            coalescer();
+    }
+
+    // Ordena e une faixas sobrepostas ou encostadas
+    void coalescer()
+    {
+        if (faixas.size() < 2)
+            return;
+        std::sort(faixas.begin(), faixas.end());
+        size_t n = 0;
+        for (size_t i = 1; i < faixas.size(); i++)
+        {
+            if (faixas[i].first <= faixas[n].second)
+                faixas[n].second = std::max(faixas[n].second, faixas[i].second);
+            else
+                faixas[++n] = faixas[i];
+        }
+        faixas.resize(n + 1);
+    }
+
+    void limpar() { faixas.clear(); }
+    bool vazia() const { return faixas.empty(); }
+};
+
+const uint16_t SEM_VAGA = 0xFFFF;
+
+// Trecho do buffer reservado para as instâncias de um chunk
+struct SegmentoInstancias
+{
+    int cx, cy, cz;
+    uint32_t inicio = 0, quantidade = 0, capacidade = 0;
+    std::vector<uint16_t> vagaDoLocal; // índice local do voxel -> vaga no segmento, ou SEM_VAGA
+    std::vector<uint16_t> localDaVaga; // vaga ocupada -> índice local do voxel
+};
+
+class InstanciasGrade
+{
+public:
+    std::vector<InstanciaVoxel> dados; // mesmo tamanho do buffer da GPU
+    FaixasSujas sujas;                 // em instâncias
+    bool realocar = true;              // o buffer precisa ser recriado e enviado inteiro
+
+    // Refaz o layout a partir da grade: cada chunk recebe um segmento com folga
+    void reconstruir(const GradeVoxel &grade)
+    {
+        segmentos.clear();
+        ordemSuja = true;
+        topo = 0;
+
+        size_t total = 0;
+        for (const auto &par : grade.chunks)
+            total += capacidadePara(par.second->ocupados);
+        dados.assign(total + std::max(total / 2, (size_t)VOXELS_POR_CHUNK), vazia());
+
+        for (const auto &par : grade.chunks)
+        {
+            const ChunkVoxel &c = *par.second;
+            SegmentoInstancias &seg = alocar(par.first, c.cx, c.cy, c.cz, capacidadePara(c.ocupados));
+            GradeVoxel::paraCadaVoxelDoChunk(c, [&](int x, int y, int z, const Voxel &v)
+            {
+                int local = GradeVoxel::indiceLocal(x % TAM_CHUNK, y % TAM_CHUNK, z % TAM_CHUNK);
+                uint16_t vaga = (uint16_t)seg.quantidade++;
+                seg.vagaDoLocal[local] = vaga;
+                seg.localDaVaga.push_back((uint16_t)local);
+                dados[seg.inicio + vaga] = instancia(grade, x, y, z, v);
+            });
+        }
+
+        realocar = true;
+        sujas.limpar();
+    }
+
+    // Atualiza a instância do voxel (x, y, z) depois que ele foi gravado na grade
+    void alterar(const GradeVoxel &grade, int x, int y, int z)
+    {
+        int cx = x / TAM_CHUNK, cy = y / TAM_CHUNK, cz = z / TAM_CHUNK;
+        uint64_t chave = GradeVoxel::chaveChunk(cx, cy, cz);
+        int local = GradeVoxel::indiceLocal(x % TAM_CHUNK, y % TAM_CHUNK, z % TAM_CHUNK);
+        Voxel v = grade.ler(x, y, z);
+        auto it = segmentos.find(chave);
+
+        if (v.visivel)
+        {
+            if (it == segmentos.end())
+            {
+                if (topo + capacidadePara(1) > dados.size())
+                {
+                    reconstruir(grade); // sem espaço: refaz tudo, já com o voxel novo
+                    return;
+                }
+                alocar(chave, cx, cy, cz, capacidadePara(1));
+                it = segmentos.find(chave);
+            }
+
+            SegmentoInstancias &seg = it->second;
+            uint16_t vaga = seg.vagaDoLocal[local];
+            if (vaga == SEM_VAGA)
+            {
+                if (seg.quantidade == seg.capacidade && !mover(seg))
+                {
+                    reconstruir(grade);
+                    return;
+                }
+                vaga = (uint16_t)seg.quantidade++;
+                seg.vagaDoLocal[local] = vaga;
+                seg.localDaVaga.push_back((uint16_t)local);
+            }
+            dados[seg.inicio + vaga] = instancia(grade, x, y, z, v);
+            sujas.marcar(seg.inicio + vaga, seg.inicio + vaga + 1);
+            return;
+        }
+
+        if (it == segmentos.end())
+            return;
+        SegmentoInstancias &seg = it->second;
+        uint16_t vaga = seg.vagaDoLocal[local];
+        if (vaga == SEM_VAGA)
+            return;
+
+        // a última instância do segmento ocupa a vaga que ficou livre
+        uint16_t ultima = (uint16_t)(seg.quantidade - 1);
+        if (vaga != ultima)
+        {
+            uint16_t movido = seg.localDaVaga[ultima];
+            dados[seg.inicio + vaga] = dados[seg.inicio + ultima];
+            seg.localDaVaga[vaga] = movido;
+            seg.vagaDoLocal[movido] = vaga;
+            sujas.marcar(seg.inicio + vaga, seg.inicio + vaga + 1);
+        }
+        dados[seg.inicio + ultima] = vazia();
+        sujas.marcar(seg.inicio + ultima, seg.inicio + ultima + 1);
+        seg.localDaVaga.pop_back();
+        seg.vagaDoLocal[local] = SEM_VAGA;
+        seg.quantidade--;
+
+        // o espaço do segmento vazio só é reaproveitado na próxima reconstrução
+        if (seg.quantidade == 0)
+        {
+            segmentos.erase(it);
+            ordemSuja = true;
+        }
+    }
+
+    // Segmentos na ordem em que aparecem no buffer; entre dois deles só há vagas vazias,
+    // então segmentos seguidos podem ser desenhados em um único draw call
+    const std::vector<const SegmentoInstancias *> &segmentosEmOrdem()
+    {
+        if (ordemSuja)
+        {
+            ordem.clear();
+            for (const auto &par : segmentos)
+                ordem.push_back(&par.second);
+            std::sort(ordem.begin(), ordem.end(), [](const SegmentoInstancias *a, const SegmentoInstancias *b)
+                      { return a->inicio < b->inicio; });
+            ordemSuja = false;
+        }
+        return ordem;
+    }
+
+private:
+    std::unordered_map<uint64_t, SegmentoInstancias> segmentos; // mesma chave dos chunks da grade
+    std::vector<const SegmentoInstancias *> ordem;
+    bool ordemSuja = true;
+    size_t topo = 0; // fim da área já reservada; daqui em diante o buffer está vazio
+
+    static InstanciaVoxel vazia()
+    {
+        return {glm::vec4(0.0f), 0u};
+    }
+
+    static InstanciaVoxel instancia(const GradeVoxel &grade, int x, int y, int z, const Voxel &v)
+    {
+        return {glm::vec4(grade.posicao(x, y, z), FATOR_ESCALA_VOXEL), (uint32_t)v.corPos};
+    }
+
+    // folga de 50% sobre a ocupação, arredondada para múltiplos de 64 instâncias
+    static uint32_t capacidadePara(int ocupados)
+    {
+        uint32_t cap = (uint32_t)(ocupados + ocupados / 2 + 63) & ~63u;
+        return std::min(std::max(cap, 64u), (uint32_t)VOXELS_POR_CHUNK);
+    }
+
+    SegmentoInstancias &alocar(uint64_t chave, int cx, int cy, int cz, uint32_t capacidade)
+    {
+        SegmentoInstancias &seg = segmentos[chave];
+        seg.cx = cx;
+        seg.cy = cy;
+        seg.cz = cz;
+        seg.inicio = (uint32_t)topo;
+        seg.quantidade = 0;
+        seg.capacidade = capacidade;
+        seg.vagaDoLocal.assign(VOXELS_POR_CHUNK, SEM_VAGA);
+        seg.localDaVaga.clear();
+        seg.localDaVaga.reserve(capacidade);
+        topo += capacidade;
+        ordemSuja = true;
+        return seg;
+    }
+
+    // Segmento cheio: copia para o fim da área reservada com o dobro da capacidade.
+    // Devolve false se o buffer não comporta, e aí o chamador reconstrói tudo.
+    bool mover(SegmentoInstancias &seg)
+    {
+        uint32_t novaCapacidade = std::min(seg.capacidade * 2, (uint32_t)VOXELS_POR_CHUNK);
+        if (topo + novaCapacidade > dados.size())
+            return false;
+
+        std::copy(dados.begin() + seg.inicio, dados.begin() + seg.inicio + seg.quantidade, dados.begin() + topo);
+        std::fill(dados.begin() + seg.inicio, dados.begin() + seg.inicio + seg.quantidade, vazia());
+        sujas.marcar(seg.inicio, seg.inicio + seg.quantidade);
+        sujas.marcar(topo, topo + seg.quantidade);
+
+        seg.inicio = (uint32_t)topo;
+        seg.capacidade = novaCapacidade;
+        topo += novaCapacidade;
+        ordemSuja = true;
+        return true;
+    }
+};
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "GradeVoxel.h"
+
+// Gerador de malhas por chunk para a grade de voxels.
+// Cada chunk cobre TAM_CHUNK³ voxels e só emite as faces que encostam em espaço vazio;
+// no modo guloso, faces coplanares vizinhas da mesma cor são unidas em um único retângulo.
+
+// Vértice da malha: posição em coordenadas de mundo e índice da cor na paleta
+struct VerticeMalha
+{
+    glm::vec3 pos;
+    uint32_t cor;
+};
+
+// Uma face fica escondida quando o vizinho é sólido e opaco, ou quando os dois têm a mesma cor
+// (assim um bloco translúcido não mostra as paredes internas entre seus voxels).
+// mascaraTranslucidas tem um bit ligado para cada índice de cor translúcido da paleta.
+inline bool faceOculta(int cor, int vizinho, uint32_t mascaraTranslucidas)
+{
+    if (vizinho < 0)
+        return false;
+    if (vizinho == cor)
+        return true;
+    return (mascaraTranslucidas & (1u << vizinho)) == 0;
+}
+
+// Emite os dois triângulos de um retângulo no plano perpendicular ao eixo d.
+// canto está em coordenadas de canto da grade; du e dv são os lados do retângulo.
+inline void emitirQuad(std::vector<VerticeMalha> &saida, glm::vec3 canto, glm::vec3 du, glm::vec3 dv,
+                       bool positivo, uint32_t cor)
+{
+    glm::vec3 p0 = canto, p1 = canto + du, p2 = canto + du + dv, p3 = canto + dv;
+
+    // mantém a ordem anti-horária vista de fora da face
+    if (positivo)
+    {
+        saida.push_back({p0, cor}); saida.push_back({p1, cor}); saida.push_back({p2, cor});
+        saida.push_back({p0, cor}); saida.push_back({p2, cor}); saida.push_back({p3, cor});
+    }
+    else
+    {
+        saida.push_back({p0, cor}); saida.push_back({p2, cor}); saida.push_back({p1, cor});
+        saida.push_back({p0, cor}); saida.push_back({p3, cor}); saida.push_back({p2, cor});
+    }
+}
+
+// Gera a malha do chunk (cx, cy, cz) de uma grade tam³.
+// corEm(x, y, z) devolve o índice da cor do voxel ou -1 se ele estiver vazio ou fora da grade.
+// origem é a posição de mundo do canto (0, 0, 0) da grade.
+template <typename FnCor>
+void gerarMalhaChunk(FnCor corEm, int cx, int cy, int cz, int tam, glm::vec3 origem, bool guloso,
+                     uint32_t mascaraTranslucidas, std::vector<VerticeMalha> &saida)
+{
+    saida.clear();
+
+    int inicio[3] = {cx * TAM_CHUNK, cy * TAM_CHUNK, cz * TAM_CHUNK};
+    int tamanho[3];
+    for (int i = 0; i < 3; i++)
+        tamanho[i] = glm::min(TAM_CHUNK, tam - inicio[i]);
+
+    // máscara de uma fatia: cor + 1 da face visível, ou 0 se não há face
+    int mascara[TAM_CHUNK * TAM_CHUNK];
+
+    for (int d = 0; d < 3; d++)
+    {
+        int u = (d + 1) % 3, v = (d + 2) % 3;
+
+        for (int sentido = -1; sentido <= 1; sentido += 2)
+        {
+            for (int fatia = 0; fatia < tamanho[d]; fatia++)
+            {
+                // monta a máscara de faces visíveis desta fatia
+                for (int j = 0; j < tamanho[v]; j++)
+                {
+                    for (int i = 0; i < tamanho[u]; i++)
+                    {
+                        int p[3];
+                        p[d] = inicio[d] + fatia;
+                        p[u] = inicio[u] + i;
+                        p[v] = inicio[v] + j;
+
+                        int cor = corEm(p[0], p[1], p[2]);
+                        int face = 0;
+                        if (cor >= 0)
+                        {
+                            p[d] += sentido;
+                            if (!faceOculta(cor, corEm(p[0], p[1], p[2]), mascaraTranslucidas))
+                                face = cor + 1;
+                        }
+                        mascara[j * TAM_CHUNK + i] = face;
+                    }
+                }
+
+                // percorre a máscara juntando retângulos da mesma cor
+                float plano = (float)(inicio[d] + fatia + (sentido > 0 ? 1 : 0));
+                for (int j = 0; j < tamanho[v]; j++)
+                {
+                    for (int i = 0; i < tamanho[u];)
+                    {
+                        int face = mascara[j * TAM_CHUNK + i];
+                        if (face == 0)
+                        {
+                            i++;
+                            continue;
+                        }
+
+                        int largura = 1, altura = 1;
+                        if (guloso)
+                        {
+                            while (i + largura < tamanho[u] && mascara[j * TAM_CHUNK + i + largura] == face)
+                                largura++;
+
+                            bool podeCrescer = true;
+                            while (j + altura < tamanho[v] && podeCrescer)
+                            {
+                                for (int k = 0; k < largura; k++)
+                                {
+                                    if (mascara[(j + altura) * TAM_CHUNK + i + k] != face)
+                                    {
+                                        podeCrescer = false;
+                                        break;
+                                    }
+                                }
+                                if (podeCrescer)
+                                    altura++;
+                            }
+                        }
+
+                        glm::vec3 canto(0.0f), du(0.0f), dv(0.0f);
+                        canto[d] = plano;
+                        canto[u] = (float)(inicio[u] + i);
+                        canto[v] = (float)(inicio[v] + j);
+                        du[u] = (float)largura;
+                        dv[v] = (float)altura;
+                        emitirQuad(saida, canto + origem, du, dv, sentido > 0, (uint32_t)(face - 1));
+
+                        // limpa a área já emitida
+                        for (int h = 0; h < altura; h++)
+                            for (int k = 0; k < largura; k++)
+                                mascara[(j + h) * TAM_CHUNK + i + k] = 0;
+
+                        i += largura;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Cópia imutável do que a malha de um chunk lê: os voxels do chunk e, de cada um dos seis
+// vizinhos, só a camada que encosta nele. Permite gerar a malha em outra thread enquanto a
+// grade continua sendo editada.
+struct VizinhancaChunk
+{
+    int cx, cy, cz;
+    Voxel centro[VOXELS_POR_CHUNK];
+    Voxel faces[6][TAM_CHUNK * TAM_CHUNK]; // -x, +x, -y, +y, -z, +z; invisíveis se o vizinho não existe
+
+    // Índice da cor em (x, y, z), coordenadas da grade, ou -1 se vazio. Vale para o chunk e
+    // para as posições a um passo dele ao longo de um eixo, que é o que gerarMalhaChunk consulta.
+    int corEm(int x, int y, int z) const
+    {
+        int l[3] = {x - cx * TAM_CHUNK, y - cy * TAM_CHUNK, z - cz * TAM_CHUNK};
+        const Voxel *v;
+        if (l[0] >= 0 && l[0] < TAM_CHUNK && l[1] >= 0 && l[1] < TAM_CHUNK && l[2] >= 0 && l[2] < TAM_CHUNK)
+            v = &centro[GradeVoxel::indiceLocal(l[0], l[1], l[2])];
+        else
+        {
+            int d = (l[0] < 0 || l[0] >= TAM_CHUNK) ? 0 : ((l[1] < 0 || l[1] >= TAM_CHUNK) ? 1 : 2);
+            int u = (d + 1) % 3, w = (d + 2) % 3;
+            v = &faces[2 * d + (l[d] < 0 ? 0 : 1)][l[u] * TAM_CHUNK + l[w]];
+        }
+        return v->visivel ? v->corPos : -1;
+    }
+};
+
+// Preenche a vizinhança a partir da grade (na thread dona da grade)
+inline void capturarVizinhanca(const GradeVoxel &grade, const ChunkVoxel &c, VizinhancaChunk &saida)
+{
+    saida.cx = c.cx;
+    saida.cy = c.cy;
+    saida.cz = c.cz;
+    std::copy(c.voxels, c.voxels + VOXELS_POR_CHUNK, saida.centro);
+
+    int cc[3] = {c.cx, c.cy, c.cz};
+    for (int d = 0; d < 3; d++)
+    {
+        int u = (d + 1) % 3, w = (d + 2) % 3;
+        for (int lado = 0; lado < 2; lado++)
+        {
+            Voxel *face = saida.faces[2 * d + lado];
+            int viz[3] = {cc[0], cc[1], cc[2]};
+            viz[d] += lado == 0 ? -1 : 1;
+            const ChunkVoxel *n = viz[d] >= 0 ? grade.chunk(viz[0], viz[1], viz[2]) : nullptr;
+            if (!n)
+            {
+                std::fill(face, face + TAM_CHUNK * TAM_CHUNK, Voxel());
+                continue;
+            }
+
+            // a camada do vizinho que encosta no chunk: a última do vizinho de baixo, a primeira do de cima
+            int l[3];
+            l[d] = lado == 0 ? TAM_CHUNK - 1 : 0;
+            for (l[u] = 0; l[u] < TAM_CHUNK; l[u]++)
+                for (l[w] = 0; l[w] < TAM_CHUNK; l[w]++)
+                    face[l[u] * TAM_CHUNK + l[w]] = n->voxels[GradeVoxel::indiceLocal(l[0], l[1], l[2])];
+        }
+    }
+}
@@ -0,0 +1,362 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cmath>
+#include <glm/glm.hpp>
+
+#include "GradeVoxel.h"
+#include "Frustum.h"
+
+// Octree esparsa construída sobre a grade, para desenhar cenas grandes com nível de detalhe.
+// Acima dos chunks os nós são explícitos e só existem onde há voxels; dentro de cada chunk a
+// octree continua de forma implícita, numa pirâmide de cores (8³, 4³, 2³ e 1³) cujo nível 0 é
+// o próprio chunk. Cada nó guarda uma cor representativa (a mais comum entre os filhos), então
+// uma região distante pode ser desenhada como um único cubo grande dessa cor.
+
+const uint8_t COR_VAZIA = 0xFF;
+
+// Deslocamento de cada nível da pirâmide de um chunk; o nível L tem (TAM_CHUNK >> L)³ células
+const int OFFSET_NIVEL_PIRAMIDE[5] = {0, 0, 512, 576, 584};
+const int TAM_PIRAMIDE = 585;
+const int NIVEIS_PIRAMIDE = 4; // 16 = 2^4
+
+struct PiramideChunk
+{
+    uint8_t cores[TAM_PIRAMIDE];
+};
+
+struct NoOctree
+{
+    int32_t filhos[8]; // índices em nos; -1 onde não há nada
+    int32_t pai;
+    int x, y, z;       // canto, em voxels
+    int tamanho;       // lado, em voxels; TAM_CHUNK nos nós que correspondem a um chunk
+    uint8_t cor;       // cor representativa
+};
+
+class OctreeVoxel
+{
+public:
+    // Refaz a octree inteira a partir da grade
+    void construir(const GradeVoxel &grade)
+    {
+        nos.clear();
+        livres.clear();
+        piramides.clear();
+        indiceChunk.clear();
+        tamRaiz = TAM_CHUNK;
+        while (tamRaiz < grade.tam)
+            tamRaiz *= 2;
+        raiz = novoNo(-1, 0, 0, 0, tamRaiz);
+        origemMundo = glm::vec3(-(float)(grade.tam / 2) - 0.5f);
+
+        for (const auto &par : grade.chunks)
+        {
+            const ChunkVoxel &c = *par.second;
+            int32_t no = noDoChunk(c.cx, c.cy, c.cz, true);
+            PiramideChunk &p = piramides[par.first];
+            for (int nivel = 1; nivel <= NIVEIS_PIRAMIDE; nivel++)
+            {
+                int n = TAM_CHUNK >> nivel;
+                for (int i = 0; i < n; i++)
+                    for (int j = 0; j < n; j++)
+                        for (int k = 0; k < n; k++)
+                            atualizarCelula(c, p, nivel, i, j, k);
+            }
+            nos[no].cor = p.cores[OFFSET_NIVEL_PIRAMIDE[NIVEIS_PIRAMIDE]];
+        }
+        atualizarCoresAbaixo(raiz);
+    }
+
+    // Atualiza o caminho do voxel (x, y, z) até a raiz depois que ele foi gravado na grade.
+    // Custa um caminho da pirâmide do chunk mais um caminho de nós: O(log tam).
+    void alterar(const GradeVoxel &grade, int x, int y, int z)
+    {
+        int cx = x / TAM_CHUNK, cy = y / TAM_CHUNK, cz = z / TAM_CHUNK;
+        uint64_t chave = GradeVoxel::chaveChunk(cx, cy, cz);
+        const ChunkVoxel *c = grade.chunk(cx, cy, cz);
+
+        if (!c)
+        {
+            // o chunk esvaziou: sai da octree e leva junto os nós que ficaram sem filhos
+            int32_t no = noDoChunk(cx, cy, cz, false);
+            if (no < 0)
+                return;
+            piramides.erase(chave);
+            indiceChunk.erase(chave);
+            int32_t pai = nos[no].pai;
+            removerFilho(pai, no);
+            while (pai != raiz && semFilhos(pai))
+            {
+                int32_t avo = nos[pai].pai;
+                removerFilho(avo, pai);
+                pai = avo;
+            }
+            atualizarCoresAcima(pai);
+            return;
+        }
+
+        int32_t no = noDoChunk(cx, cy, cz, true);
+        auto it = piramides.find(chave);
+        bool nova = it == piramides.end();
+        PiramideChunk &p = piramides[chave];
+        int lx = x % TAM_CHUNK, ly = y % TAM_CHUNK, lz = z % TAM_CHUNK;
+        for (int nivel = 1; nivel <= NIVEIS_PIRAMIDE; nivel++)
+        {
+            if (nova)
+            {
+                // pirâmide recém-criada: preenche o nível inteiro
+                int n = TAM_CHUNK >> nivel;
+                for (int i = 0; i < n; i++)
+                    for (int j = 0; j < n; j++)
+                        for (int k = 0; k < n; k++)
+                            atualizarCelula(*c, p, nivel, i, j, k);
+            }
+            else
+                atualizarCelula(*c, p, nivel, lx >> nivel, ly >> nivel, lz >> nivel);
+        }
+        nos[no].cor = p.cores[OFFSET_NIVEL_PIRAMIDE[NIVEIS_PIRAMIDE]];
+        atualizarCoresAcima(nos[no].pai);
+    }
+
+    // Percorre a octree escolhendo a profundidade de cada região pelo tamanho projetado:
+    // uma célula cujo lado ocupa no máximo limiarPixels na tela é emitida inteira, com a cor
+    // representativa. escalaTela = altura da tela em pixels / (2 tan(fov / 2)).
+    // emitir(centro, lado, cor) recebe o centro em coordenadas de mundo e o lado em voxels.
+    template <typename Fn>
+    void selecionarLOD(const GradeVoxel &grade, const Frustum &frustum, glm::vec3 camera,
+                       float escalaTela, float limiarPixels, Fn emitir) const
+    {
+        if (raiz < 0)
+            return;
+        LOD<Fn> lod = {this, &grade, &frustum, camera, limiarPixels / escalaTela, emitir};
+        lod.no(raiz);
+    }
+
+    size_t quantidadeNos() const { return nos.size() - livres.size(); }
+    size_t bytes() const
+    {
+        return nos.capacity() * sizeof(NoOctree) + piramides.size() * (sizeof(PiramideChunk) + sizeof(uint64_t) + 2 * sizeof(void *)) +
+               indiceChunk.size() * (sizeof(uint64_t) + sizeof(int32_t) + 2 * sizeof(void *));
+    }
+
+private:
+    std::vector<NoOctree> nos;
+    std::vector<int32_t> livres;
+    std::unordered_map<uint64_t, PiramideChunk> piramides; // mesma chave dos chunks da grade
+    std::unordered_map<uint64_t, int32_t> indiceChunk;     // chave do chunk -> nó
+    int32_t raiz = -1;
+    int tamRaiz = 0;
+    glm::vec3 origemMundo; // posição de mundo do canto (0, 0, 0) da grade
+
+    int32_t novoNo(int32_t pai, int x, int y, int z, int tamanho)
+    {
+        NoOctree n;
+        for (int i = 0; i < 8; i++)
+            n.filhos[i] = -1;
+        n.pai = pai;
+        n.x = x;
+        n.y = y;
+        n.z = z;
+        n.tamanho = tamanho;
+        n.cor = COR_VAZIA;
+        if (!livres.empty())
+        {
+            int32_t i = livres.back();
+            livres.pop_back();
+            nos[i] = n;
+            return i;
+        }
+        nos.push_back(n);
+        return (int32_t)nos.size() - 1;
+    }
+
+    // Nó do chunk (cx, cy, cz), criando o caminho desde a raiz se criar for true
+    int32_t noDoChunk(int cx, int cy, int cz, bool criar)
+    {
+        uint64_t chave = GradeVoxel::chaveChunk(cx, cy, cz);
+        auto it = indiceChunk.find(chave);
+        if (it != indiceChunk.end())
+            return it->second;
+        if (!criar)
+            return -1;
+
+        int x = cx * TAM_CHUNK, y = cy * TAM_CHUNK, z = cz * TAM_CHUNK;
+        int32_t atual = raiz;
+        while (nos[atual].tamanho > TAM_CHUNK)
+        {
+            int metade = nos[atual].tamanho / 2;
+            int ox = x >= nos[atual].x + metade, oy = y >= nos[atual].y + metade, oz = z >= nos[atual].z + metade;
+            int f = (ox << 2) | (oy << 1) | oz;
+            if (nos[atual].filhos[f] < 0)
+            {
+                int32_t filho = novoNo(atual, nos[atual].x + ox * metade, nos[atual].y + oy * metade, nos[atual].z + oz * metade, metade);
+                nos[atual].filhos[f] = filho; // novoNo pode ter realocado nos: só escreve depois
+            }
+            atual = nos[atual].filhos[f];
+        }
+        indiceChunk[chave] = atual;
+        return atual;
+    }
+
+    void removerFilho(int32_t pai, int32_t filho)
+    {
+        for (int i = 0; i < 8; i++)
+            if (nos[pai].filhos[i] == filho)
+                nos[pai].filhos[i] = -1;
+        livres.push_back(filho);
+    }
+
+    bool semFilhos(int32_t no) const
+    {
+        for (int i = 0; i < 8; i++)
+            if (nos[no].filhos[i] >= 0)
+                return false;
+        return true;
+    }
+
+    // A cor mais comum entre as oito, ignorando as vazias; empate fica com a primeira
+    static uint8_t corRepresentativa(const uint8_t cores[8])
+    {
+        uint8_t melhor = COR_VAZIA;
+        int melhorContagem = 0;
+        for (int i = 0; i < 8; i++)
+        {
+            if (cores[i] == COR_VAZIA)
+                continue;
+            int contagem = 0;
+            for (int j = 0; j < 8; j++)
+                contagem += cores[j] == cores[i];
+            if (contagem > melhorContagem)
+            {
+                melhor = cores[i];
+                melhorContagem = contagem;
+            }
+        }
+        return melhor;
+    }
+
+    static int indicePiramide(int nivel, int i, int j, int k)
+    {
+        int n = TAM_CHUNK >> nivel;
+        return OFFSET_NIVEL_PIRAMIDE[nivel] + (i * n + j) * n + k;
+    }
+
+    // Cor de uma célula da pirâmide; o nível 0 vem direto dos voxels do chunk
+    static uint8_t corCelula(const ChunkVoxel &c, const PiramideChunk &p, int nivel, int i, int j, int k)
+    {
+        if (nivel == 0)
+        {
+            int local = GradeVoxel::indiceLocal(i, j, k);
+            return c.ocupado(local) ? c.voxels[local].corPos : COR_VAZIA;
+        }
+        return p.cores[indicePiramide(nivel, i, j, k)];
+    }
+
+    static void atualizarCelula(const ChunkVoxel &c, PiramideChunk &p, int nivel, int i, int j, int k)
+    {
+        uint8_t filhos[8];
+        for (int f = 0; f < 8; f++)
+            filhos[f] = corCelula(c, p, nivel - 1, 2 * i + (f >> 2), 2 * j + ((f >> 1) & 1), 2 * k + (f & 1));
+        p.cores[indicePiramide(nivel, i, j, k)] = corRepresentativa(filhos);
+    }
+
+    uint8_t corDoNo(int32_t no) const
+    {
+        uint8_t filhos[8];
+        for (int f = 0; f < 8; f++)
+            filhos[f] = nos[no].filhos[f] >= 0 ? nos[nos[no].filhos[f]].cor : COR_VAZIA;
+        return corRepresentativa(filhos);
+    }
+
+    void atualizarCoresAcima(int32_t no)
+    {
+        for (; no >= 0; no = nos[no].pai)
+            nos[no].cor = corDoNo(no);
+    }
+
+    void atualizarCoresAbaixo(int32_t no)
+    {
+        if (nos[no].tamanho == TAM_CHUNK)
+            return; // a cor do chunk vem da pirâmide
+        for (int f = 0; f < 8; f++)
+            if (nos[no].filhos[f] >= 0)
+                atualizarCoresAbaixo(nos[no].filhos[f]);
+        nos[no].cor = corDoNo(no);
+    }
+
+    template <typename Fn>
+    struct LOD
+    {
+        const OctreeVoxel *octree;
+        const GradeVoxel *grade;
+        const Frustum *frustum;
+        glm::vec3 camera;
+        float limiar; // lado máximo / distância para emitir uma célula inteira
+        Fn emitir;
+
+        // Decide se a célula de canto (em voxels) e lado dados é desenhada inteira, é
+        // descartada pelo frustum (devolve false) ou precisa ser refinada
+        int classificar(glm::ivec3 canto, int lado, glm::vec3 &centro) const
+        {
+            glm::vec3 minimo = octree->origemMundo + glm::vec3(canto);
+            glm::vec3 maximo = minimo + glm::vec3((float)lado);
+            if (!caixaNoFrustum(*frustum, minimo, maximo))
+                return 0;
+            centro = (minimo + maximo) * 0.5f;
+            float distancia = glm::length(centro - camera) - 0.87f * lado; // até a esfera que envolve a célula
+            if (lado == 1 || (distancia > 0.0f && lado <= limiar * distancia))
+                return 1;
+            return 2;
+        }
+
+        void no(int32_t indice)
+        {
+            const NoOctree &n = octree->nos[indice];
+            glm::vec3 centro;
+            int c = classificar(glm::ivec3(n.x, n.y, n.z), n.tamanho, centro);
+            if (c == 0)
+                return;
+            if (c == 1)
+            {
+                emitir(centro, n.tamanho, n.cor);
+                return;
+            }
+            if (n.tamanho == TAM_CHUNK)
+            {
+                int cx = n.x / TAM_CHUNK, cy = n.y / TAM_CHUNK, cz = n.z / TAM_CHUNK;
+                const ChunkVoxel *cv = grade->chunk(cx, cy, cz);
+                const PiramideChunk &p = octree->piramides.at(GradeVoxel::chaveChunk(cx, cy, cz));
+                for (int f = 0; f < 8; f++)
+                    celula(*cv, p, NIVEIS_PIRAMIDE - 1, f >> 2, (f >> 1) & 1, f & 1);
+                return;
+            }
+            for (int f = 0; f < 8; f++)
+                if (n.filhos[f] >= 0)
+                    no(n.filhos[f]);
+        }
+
+        // Célula (i, j, k) do nível da pirâmide de um chunk
+        void celula(const ChunkVoxel &c, const PiramideChunk &p, int nivel, int i, int j, int k)
+        {
+            uint8_t cor = corCelula(c, p, nivel, i, j, k);
+            if (cor == COR_VAZIA)
+                return;
+            int lado = 1 << nivel;
+            glm::ivec3 canto(c.cx * TAM_CHUNK + i * lado, c.cy * TAM_CHUNK + j * lado, c.cz * TAM_CHUNK + k * lado);
+            glm::vec3 centro;
+            int cl = classificar(canto, lado, centro);
+            if (cl == 0)
+                return;
+            if (cl == 1)
+            {
+                emitir(centro, lado, cor);
+                return;
+            }
+            for (int f = 0; f < 8; f++)
+                celula(c, p, nivel - 1, 2 * i + (f >> 2), 2 * j + ((f >> 1) & 1), 2 * k + (f & 1));
+        }
+    };
+};
@@ -0,0 +1,272 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <glm/glm.hpp>
+
+#include "GradeVoxel.h"
+#include "PoolThreads.h"
+
+// Operações em massa na grade: preencher caixa, preencher esfera, substituir cor e
+// preenchimento por inundação (vizinhança 6). O cálculo roda no pool, um chunk por tarefa,
+// lendo a grade sem alterá-la; o resultado é a lista das mudanças de cada chunk, que o editor
+// aplica de uma vez entre dois frames (e registra no histórico como uma única operação).
+
+// Um voxel a mudar, pelo índice local no chunk
+struct AlteracaoVoxel
+{
+    uint16_t local;
+    Voxel novo;
+};
+
+struct AlteracoesChunk
+{
+    int cx, cy, cz;
+    std::vector<AlteracaoVoxel> alteracoes;
+};
+
+typedef std::vector<AlteracoesChunk> ResultadoOperacao;
+
+inline size_t contarAlteracoes(const ResultadoOperacao &r)
+{
+    size_t total = 0;
+    for (const AlteracoesChunk &c : r)
+        total += c.alteracoes.size();
+    return total;
+}
+
+inline bool mesmoVoxel(const Voxel &a, const Voxel &b)
+{
+    return a.visivel == b.visivel && (!a.visivel || a.corPos == b.corPos);
+}
+
+// Percorre em paralelo os chunks que cortam a caixa [minimo, maximo] (inclusiva, já limitada
+// à grade); novoValor(x, y, z, atual, novo) decide se o voxel muda e para quê
+template <typename Fn>
+ResultadoOperacao calcularNaCaixa(const GradeVoxel &grade, PoolThreads &pool, glm::ivec3 minimo, glm::ivec3 maximo, Fn novoValor)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        minimo[i] = std::max(minimo[i], 0);
+        maximo[i] = std::min(maximo[i], grade.tam - 1);
+        if (minimo[i] > maximo[i])
+            return ResultadoOperacao();
+    }
+
+    ResultadoOperacao resultado;
+    for (int cx = minimo.x / TAM_CHUNK; cx <= maximo.x / TAM_CHUNK; cx++)
+        for (int cy = minimo.y / TAM_CHUNK; cy <= maximo.y / TAM_CHUNK; cy++)
+            for (int cz = minimo.z / TAM_CHUNK; cz <= maximo.z / TAM_CHUNK; cz++)
+                resultado.push_back({cx, cy, cz, {}});
+
+    pool.paraCada(resultado.size(), [&](size_t i)
+    {
+        AlteracoesChunk &saida = resultado[i];
+        const ChunkVoxel *c = grade.chunk(saida.cx, saida.cy, saida.cz);
+        int x0 = saida.cx * TAM_CHUNK, y0 = saida.cy * TAM_CHUNK, z0 = saida.cz * TAM_CHUNK;
+        int lx0 = std::max(minimo.x - x0, 0), lx1 = std::min(maximo.x - x0, TAM_CHUNK - 1);
+        int ly0 = std::max(minimo.y - y0, 0), ly1 = std::min(maximo.y - y0, TAM_CHUNK - 1);
+        int lz0 = std::max(minimo.z - z0, 0), lz1 = std::min(maximo.z - z0, TAM_CHUNK - 1);
+        Voxel vazio;
+        for (int lx = lx0; lx <= lx1; lx++)
+            for (int ly = ly0; ly <= ly1; ly++)
+                for (int lz = lz0; lz <= lz1; lz++)
+                {
+                    int local = GradeVoxel::indiceLocal(lx, ly, lz);
+                    const Voxel &atual = c ? c->voxels[local] : vazio;
+                    Voxel novo;
+                    if (novoValor(x0 + lx, y0 + ly, z0 + lz, atual, novo) && !mesmoVoxel(atual, novo))
+                        saida.alteracoes.push_back({(uint16_t)local, novo});
+                }
+    });
+
+    resultado.erase(std::remove_if(resultado.begin(), resultado.end(), [](const AlteracoesChunk &c)
+                                   { return c.alteracoes.empty(); }),
+                    resultado.end());
+    return resultado;
+}
+
+// Caixa entre dois cantos quaisquer (inclusiva); v invisível apaga
+inline ResultadoOperacao preencherCaixa(const GradeVoxel &grade, PoolThreads &pool, glm::ivec3 a, glm::ivec3 b, Voxel v)
+{
+    glm::ivec3 minimo(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z));
+    glm::ivec3 maximo(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z));
+    return calcularNaCaixa(grade, pool, minimo, maximo, [v](int, int, int, const Voxel &, Voxel &novo)
+    {
+        novo = v;
+        return true;
+    });
+}
+
+// Voxels cujo centro está a no máximo raio (em voxels) do centro dado
+inline ResultadoOperacao preencherEsfera(const GradeVoxel &grade, PoolThreads &pool, glm::ivec3 centro, float raio, Voxel v)
+{
+    int r = (int)std::ceil(raio);
+    float raio2 = raio * raio;
+    return calcularNaCaixa(grade, pool, centro - glm::ivec3(r), centro + glm::ivec3(r), [=](int x, int y, int z, const Voxel &, Voxel &novo)
+    {
+        float dx = (float)(x - centro.x), dy = (float)(y - centro.y), dz = (float)(z - centro.z);
+        novo = v;
+        return dx * dx + dy * dy + dz * dz <= raio2;
+    });
+}
+
+// Troca a cor de todos os voxels visíveis da cor de por para; só percorre os chunks existentes
+inline ResultadoOperacao substituirCor(const GradeVoxel &grade, PoolThreads &pool, uint8_t de, uint8_t para)
+{
+    std::vector<const ChunkVoxel *> chunks;
+    chunks.reserve(grade.chunks.size());
+    for (const auto &par : grade.chunks)
+        chunks.push_back(par.second.get());
+
+    ResultadoOperacao resultado(chunks.size());
+    pool.paraCada(chunks.size(), [&](size_t i)
+    {
+        const ChunkVoxel &c = *chunks[i];
+        AlteracoesChunk &saida = resultado[i];
+        saida.cx = c.cx;
+        saida.cy = c.cy;
+        saida.cz = c.cz;
+        if (de == para)
+            return;
+        GradeVoxel::paraCadaOcupado(c, [&](int local)
+        {
+            Voxel v = c.voxels[local];
+            if (v.corPos == de)
+            {
+                v.corPos = para;
+                saida.alteracoes.push_back({(uint16_t)local, v});
+            }
+        });
+    });
+
+    resultado.erase(std::remove_if(resultado.begin(), resultado.end(), [](const AlteracoesChunk &c)
+                                   { return c.alteracoes.empty(); }),
+                    resultado.end());
+    return resultado;
+}
+
+// Estado de um chunk durante a inundação; cada chunk é processado por uma única tarefa por rodada
+struct ChunkInundacao
+{
+    int cx, cy, cz;
+    uint64_t visitados[VOXELS_POR_CHUNK / 64] = {};
+    std::vector<uint16_t> sementes;        // índices locais a explorar na próxima rodada
+    std::vector<AlteracaoVoxel> alteracoes;
+    std::vector<glm::ivec3> saidas;        // vizinhos em outros chunks, encontrados na rodada
+};
+
+// Preenchimento por inundação a partir de inicio: todos os voxels iguais a ele (visibilidade e
+// cor) ligados por faces passam a valer v. Roda em rodadas: em cada uma, os chunks com
+// sementes fazem a busca dentro de si em paralelo e devolvem as sementes que cruzam a borda,
+// distribuídas depois pela thread que chamou. Devolve false, sem alterações, se a região
+// passar de limite voxels (por exemplo, ao inundar o vazio em volta de tudo).
+inline bool preencherInundacao(const GradeVoxel &grade, PoolThreads &pool, glm::ivec3 inicio, Voxel v, size_t limite,
+                               ResultadoOperacao &resultado)
+{
+    resultado.clear();
+    if (!grade.dentro(inicio.x, inicio.y, inicio.z))
+        return true;
+    Voxel alvo = grade.ler(inicio.x, inicio.y, inicio.z);
+    if (mesmoVoxel(alvo, v))
+        return true;
+
+    std::unordered_map<uint64_t, std::unique_ptr<ChunkInundacao>> estados;
+    std::vector<ChunkInundacao *> pendentes;
+    auto semear = [&](glm::ivec3 p)
+    {
+        int cx = p.x / TAM_CHUNK, cy = p.y / TAM_CHUNK, cz = p.z / TAM_CHUNK;
+        std::unique_ptr<ChunkInundacao> &e = estados[GradeVoxel::chaveChunk(cx, cy, cz)];
+        if (!e)
+        {
+            e.reset(new ChunkInundacao());
+            e->cx = cx;
+            e->cy = cy;
+            e->cz = cz;
+        }
+        int local = GradeVoxel::indiceLocal(p.x % TAM_CHUNK, p.y % TAM_CHUNK, p.z % TAM_CHUNK);
+        if (e->visitados[local >> 6] & (1ull << (local & 63)))
+            return;
+        if (e->sementes.empty())
+            pendentes.push_back(e.get());
+        e->sementes.push_back((uint16_t)local);
+    };
+
+    semear(inicio);
+    size_t total = 0;
+    std::vector<ChunkInundacao *> rodada;
+    std::vector<size_t> antes;
+    while (!pendentes.empty())
+    {
+        rodada.swap(pendentes);
+        pendentes.clear();
+        antes.resize(rodada.size());
+        for (size_t i = 0; i < rodada.size(); i++)
+            antes[i] = rodada[i]->alteracoes.size();
+
+        pool.paraCada(rodada.size(), [&](size_t i)
+        {
+            ChunkInundacao &e = *rodada[i];
+            const ChunkVoxel *c = grade.chunk(e.cx, e.cy, e.cz);
+            Voxel vazio;
+            int x0 = e.cx * TAM_CHUNK, y0 = e.cy * TAM_CHUNK, z0 = e.cz * TAM_CHUNK;
+            std::vector<uint16_t> pilha;
+            pilha.swap(e.sementes);
+            while (!pilha.empty())
+            {
+                int local = pilha.back();
+                pilha.pop_back();
+                uint64_t bit = 1ull << (local & 63);
+                if (e.visitados[local >> 6] & bit)
+                    continue;
+                if (!mesmoVoxel(c ? c->voxels[local] : vazio, alvo))
+                    continue;
+                e.visitados[local >> 6] |= bit;
+                e.alteracoes.push_back({(uint16_t)local, v});
+
+                int l[3] = {local / (TAM_CHUNK * TAM_CHUNK), (local / TAM_CHUNK) % TAM_CHUNK, local % TAM_CHUNK};
+                for (int d = 0; d < 3; d++)
+                    for (int passo = -1; passo <= 1; passo += 2)
+                    {
+                        int viz[3] = {l[0], l[1], l[2]};
+                        viz[d] += passo;
+                        if (viz[d] >= 0 && viz[d] < TAM_CHUNK)
+                        {
+                            int g[3] = {x0 + viz[0], y0 + viz[1], z0 + viz[2]};
+                            if (g[d] < grade.tam) // chunks da borda podem passar do fim da grade
+                                pilha.push_back((uint16_t)GradeVoxel::indiceLocal(viz[0], viz[1], viz[2]));
+                        }
+                        else
+                        {
+                            glm::ivec3 g(x0 + viz[0], y0 + viz[1], z0 + viz[2]);
+                            if (grade.dentro(g.x, g.y, g.z))
+                                e.saidas.push_back(g);
+                        }
+                    }
+            }
+        });
+
+        for (size_t i = 0; i < rodada.size(); i++)
+            total += rodada[i]->alteracoes.size() - antes[i];
+        if (total > limite)
+            return false;
+
+        for (ChunkInundacao *e : rodada)
+        {
+            for (const glm::ivec3 &p : e->saidas)
+                semear(p);
+            e->saidas.clear();
+        }
+    }
+
+    resultado.reserve(estados.size());
+    for (auto &par : estados)
+        if (!par.second->alteracoes.empty())
+            resultado.push_back({par.second->cx, par.second->cy, par.second->cz, std::move(par.second->alteracoes)});
+    return true;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <cstddef>
+
+// Pool fixo de threads de trabalho com uma fila de tarefas.
+// paraCada divide um laço entre as threads e a thread que chamou, que também trabalha e só
+// volta quando todos os índices terminaram; enfileirar só agenda a tarefa e volta na hora.
+// A fila é uma só (as malhas também passam por ela), então os ajudantes de paraCada podem ficar
+// atrás de muitas tarefas: quem chama não espera por eles, só pelos que chegaram a pegar índice.
+class PoolThreads
+{
+public:
+    // n = 0: uma thread a menos que o número de núcleos, pois quem chama paraCada também trabalha
+    explicit PoolThreads(unsigned n = 0)
+    {
+        if (n == 0)
+        {
+            unsigned nucleos = std::thread::hardware_concurrency();
+            n = nucleos > 1 ? nucleos - 1 : 1;
+        }
+        for (unsigned i = 0; i < n; i++)
+            threads.emplace_back([this]() { trabalhar(); });
+    }
+
+    ~PoolThreads()
+    {
+        {
+            std::lock_guard<std::mutex> trava(mutex);
+            encerrar = true;
+        }
+        avisoTarefa.notify_all();
+        for (std::thread &t : threads)
+            t.join();
+    }
+
+    PoolThreads(const PoolThreads &) = delete;
+    PoolThreads &operator=(const PoolThreads &) = delete;
+
+    unsigned quantidade() const { return (unsigned)threads.size(); }
+
+    void enfileirar(std::function<void()> tarefa)
+    {
+        {
+            std::lock_guard<std::mutex> trava(mutex);
+            tarefas.push_back(std::move(tarefa));
+        }
+        avisoTarefa.notify_one();
+    }
+
+    // Chama fn(i) para todo i em [0, n), distribuindo os índices um a um entre as threads
+    template <typename Fn>
+    void paraCada(size_t n, Fn fn)
+    {
+        if (n == 0)
+            return;
+
+        // o estado sobrevive a paraCada: um ajudante que só sai da fila depois de tudo pronto
+        // ainda o consulta, vê que não há mais índices e sai sem tocar em fn
+        struct Laco
+        {
+            std::atomic<size_t> proximo{0};
+            std::mutex mutex;
+            std::condition_variable fim;
+            unsigned ajudantesAtivos = 0; // ajudantes que entraram no laço e ainda não saíram
+        };
+        std::shared_ptr<Laco> laco = std::make_shared<Laco>();
+        Fn *funcao = &fn;
+
+        // não adianta acordar mais ajudantes que índices
+        unsigned ajudantes = (unsigned)std::min<size_t>(threads.size(), n - 1);
+        for (unsigned a = 0; a < ajudantes; a++)
+        {
+            enfileirar([laco, funcao, n]()
+            {
+                {
+                    // testar e entrar sob o mutex: ou quem chamou ainda vai esperar por este
+                    // ajudante, ou os índices já acabaram e fn pode nem existir mais
+                    std::lock_guard<std::mutex> trava(laco->mutex);
+                    if (laco->proximo >= n)
+                        return;
+                    laco->ajudantesAtivos++;
+                }
+                for (size_t i = laco->proximo++; i < n; i = laco->proximo++)
+                    (*funcao)(i);
+                std::lock_guard<std::mutex> trava(laco->mutex);
+                if (--laco->ajudantesAtivos == 0)
+                    laco->fim.notify_one();
+            });
+        }
+
+        for (size_t i = laco->proximo++; i < n; i = laco->proximo++)
+            fn(i);
+
+        // os índices acabaram; falta só quem ainda está no meio de um deles
+        std::unique_lock<std::mutex> trava(laco->mutex);
+        laco->fim.wait(trava, [&laco]() { return laco->ajudantesAtivos == 0; });
+    }
+
+private:
+    std::vector<std::thread> threads;
+    std::deque<std::function<void()>> tarefas;
+    std::mutex mutex;
+    std::condition_variable avisoTarefa;
+    bool encerrar = false;
+
+    void trabalhar()
+    {
+        while (true)
+        {
+            std::function<void()> tarefa;
+            {
+                std::unique_lock<std::mutex> trava(mutex);
+                avisoTarefa.wait(trava, [this]() { return encerrar || !tarefas.empty(); });
+                if (encerrar && tarefas.empty())
+                    return;
+                tarefa = std::move(tarefas.front());
+                tarefas.pop_front();
+            }
+            tarefa();
+        }
+    }
+};
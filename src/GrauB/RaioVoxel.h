@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <glm/glm.hpp>
+
+#include "GradeVoxel.h"
+
+// Lançamento de raios na grade com o percurso 3D DDA de Amanatides e Woo:
+// o raio avança de célula em célula pela fronteira mais próxima, então o custo é
+// proporcional às células atravessadas e não ao tamanho da grade.
+
+// Primeiro voxel sólido atingido por um raio
+struct AcertoVoxel
+{
+    glm::ivec3 voxel;     // índice do voxel na grade
+    glm::ivec3 normal;    // face atingida, apontando para fora do voxel (zero se o raio nasceu dentro dele)
+    float distancia;      // ao longo da direção normalizada, em unidades de mundo
+    int celulasVisitadas; // quantas células o percurso testou
+};
+
+// Lança o raio origem + t * direcao (coordenadas de mundo, t em [0, alcance]).
+// Devolve true e preenche acerto se encontrar um voxel visível.
+inline bool lancarRaio(const GradeVoxel &grade, glm::vec3 origem, glm::vec3 direcao, float alcance, AcertoVoxel &acerto)
+{
+    const float INF = std::numeric_limits<float>::infinity();
+    int tam = grade.tam;
+    if (tam <= 0 || glm::dot(direcao, direcao) == 0.0f)
+        return false;
+    direcao = glm::normalize(direcao);
+
+    // em coordenadas de grade o voxel i ocupa [i, i + 1): o centro dele está em i - tam / 2 no mundo
+    glm::vec3 o = origem + glm::vec3((float)(tam / 2) + 0.5f);
+
+    // recorta o raio pela caixa [0, tam]³ da grade
+    float tEntrada = 0.0f, tSaida = alcance;
+    int eixoEntrada = -1;
+    for (int i = 0; i < 3; i++)
+    {
+        if (direcao[i] == 0.0f)
+        {
+            if (o[i] < 0.0f || o[i] >= (float)tam)
+                return false;
+            continue;
+        }
+        float t1 = (0.0f - o[i]) / direcao[i];
+        float t2 = ((float)tam - o[i]) / direcao[i];
+        if (t1 > t2)
+            std::swap(t1, t2);
+        if (t1 > tEntrada)
+        {
+            tEntrada = t1;
+            eixoEntrada = i;
+        }
+        tSaida = glm::min(tSaida, t2);
+    }
+    if (tEntrada > tSaida)
+        return false;
+
+    glm::vec3 p = o + direcao * tEntrada;
+    glm::ivec3 celula, passo, normal(0);
+    glm::vec3 tMax, tDelta;
+    for (int i = 0; i < 3; i++)
+    {
+        celula[i] = glm::clamp((int)std::floor(p[i]), 0, tam - 1);
+        passo[i] = direcao[i] > 0.0f ? 1 : (direcao[i] < 0.0f ? -1 : 0);
+        tDelta[i] = passo[i] != 0 ? std::fabs(1.0f / direcao[i]) : INF;
+        if (passo[i] > 0)
+            tMax[i] = ((float)(celula[i] + 1) - o[i]) / direcao[i];
+        else if (passo[i] < 0)
+            tMax[i] = ((float)celula[i] - o[i]) / direcao[i];
+        else
+            tMax[i] = INF;
+    }
+    if (eixoEntrada >= 0)
+        normal[eixoEntrada] = -passo[eixoEntrada];
+
+    // o chunk só é procurado na tabela quando o raio entra em outro
+    const ChunkVoxel *chunk = nullptr;
+    glm::ivec3 chunkAtual(-1);
+    float t = tEntrada;
+    int visitadas = 0;
+
+    while (true)
+    {
+        visitadas++;
+        glm::ivec3 cc(celula.x / TAM_CHUNK, celula.y / TAM_CHUNK, celula.z / TAM_CHUNK);
+        if (cc != chunkAtual)
+        {
+            chunkAtual = cc;
+            chunk = grade.chunk(cc.x, cc.y, cc.z);
+        }
+        if (chunk)
+        {
+            int local = GradeVoxel::indiceLocal(celula.x % TAM_CHUNK, celula.y % TAM_CHUNK, celula.z % TAM_CHUNK);
+            if (chunk->ocupado(local))
+            {
+                acerto.voxel = celula;
+                acerto.normal = normal;
+                acerto.distancia = t;
+                acerto.celulasVisitadas = visitadas;
+                return true;
+            }
+        }
+
+        // atravessa a fronteira mais próxima
+        int eixo = tMax.x < tMax.y ? (tMax.x < tMax.z ? 0 : 2) : (tMax.y < tMax.z ? 1 : 2);
+        if (tMax[eixo] > tSaida)
+            break;
+        t = tMax[eixo];
+        celula[eixo] += passo[eixo];
+        if (celula[eixo] < 0 || celula[eixo] >= tam)
+            break;
+        tMax[eixo] += tDelta[eixo];
+        normal = glm::ivec3(0);
+        normal[eixo] = -passo[eixo];
+    }
+    return false;
+}
@@ -43,6 +43,9 @@ using namespace std;
 
 using namespace glm;
 
+// Programa de shader compartilhado e bloco de câmera
+#include "ProgramaShader.h"
+
 // STB_IMAGE
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
@@ -61,10 +64,9 @@ struct Sprite
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode);
 
 // Protótipos das funções
-int setupShader();
 int setupSprite();
 int loadTexture(string filePath);
-void drawSprite(GLuint shaderID, Sprite spr);
+void drawSprite(GLint modelLoc, Sprite spr);
 
 // Dimensões da janela (pode ser alterado em tempo de execução)
 const GLuint WIDTH = 800, HEIGHT = 600;
@@ -75,13 +77,13 @@ const GLchar *vertexShaderSource = R"(
  layout (location = 0) in vec2 position;
  layout (location = 1) in vec2 texc;
  
- uniform mat4 projection;
+ layout (std140) uniform Camera { mat4 view; mat4 proj; };
  uniform mat4 model;
  out vec2 tex_coord;
  void main()
  {
 	tex_coord = vec2(texc.s,1.0-texc.t);
-	gl_Position = projection * model * vec4(position, 0.0, 1.0);
+	gl_Position = proj * view * model * vec4(position, 0.0, 1.0);
  }
  )";
 
@@ -158,7 +160,11 @@ int main()
 	glViewport(0, 0, width, height);
 
 	// Compilando e buildando o programa de shader
-	GLuint shaderID = setupShader();
+	ProgramaShader shader(vertexShaderSource, fragmentShaderSource);
+	GLuint shaderID = shader.id;
+
+	// A localização da matriz model é buscada uma vez aqui, e não a cada sprite desenhado
+	GLint modelLoc = shader.uniform("model");
 
 	Sprite background, spr1, spr2;
 
@@ -192,13 +198,15 @@ int main()
 	glActiveTexture(GL_TEXTURE0);
 
 	// Criando a variável uniform pra mandar a textura pro shader
-	glUniform1i(glGetUniformLocation(shaderID, "tex_buff"), 0);
+	glUniform1i(shader.uniform("tex_buff"), 0);
 
 	// Criação da matriz de projeção paralela ortográfica
 	mat4 projection = mat4(1); // matriz identidade
 	projection = ortho(0.0, 800.0, 0.0, 600.0, -1.0, 1.0);
-	// Envio para o shader
-	glUniformMatrix4fv(glGetUniformLocation(shaderID, "projection"), 1, GL_FALSE, value_ptr(projection));
+	// Envio para o shader pelo bloco de câmera (a câmera 2D não tem transformação de visualização)
+	BlocoCamera camera;
+	camera.criar();
+	camera.enviar(mat4(1), projection);
 
 	//Habilitando transparência/função de mistura
 	glEnable(GL_BLEND);
@@ -248,15 +256,16 @@ int main()
 			spr1.pos.x += 1;		
 		}
 
-		drawSprite(shaderID,background);
-		drawSprite(shaderID,spr1);
-		drawSprite(shaderID,spr2);
+		drawSprite(modelLoc,background);
+		drawSprite(modelLoc,spr1);
+		drawSprite(modelLoc,spr2);
 		
 		// Troca os buffers da tela
 		glfwSwapBuffers(window);
 	}
 	// Pede pra OpenGL desalocar os buffers
 	glDeleteVertexArrays(1, &VAO);
+	camera.destruir();
 	// Finaliza a execução da GLFW, limpando os recursos alocados por ela
 	glfwTerminate();
 	return 0;
@@ -280,58 +289,6 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
 	}
 }
 
-// Esta função está bastante hardcoded - objetivo é compilar e "buildar" um programa de
-//  shader simples e único neste exemplo de código
-//  O código fonte do vertex e fragment shader está nos arrays vertexShaderSource e
-//  fragmentShader source no iniçio deste arquivo
-//  A função retorna o identificador do programa de shader
-int setupShader()
-{
-	// Vertex shader
-	GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-	glCompileShader(vertexShader);
-	// Checando erros de compilação (exibição via log no terminal)
-	GLint success;
-	GLchar infoLog[512];
-	glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n"
-				  << infoLog << std::endl;
-	}
-	// Fragment shader
-	GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-	glCompileShader(fragmentShader);
-	// Checando erros de compilação (exibição via log no terminal)
-	glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n"
-				  << infoLog << std::endl;
-	}
-	// Linkando os shaders e criando o identificador do programa de shader
-	GLuint shaderProgram = glCreateProgram();
-	glAttachShader(shaderProgram, vertexShader);
-	glAttachShader(shaderProgram, fragmentShader);
-	glLinkProgram(shaderProgram);
-	// Checando por erros de linkagem
-	glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-	if (!success)
-	{
-		glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
-				  << infoLog << std::endl;
-	}
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
-
-	return shaderProgram;
-}
-
 // Esta função está bastante harcoded - objetivo é criar os buffers que armazenam a
 // geometria de um triângulo
 // Apenas atributo coordenada nos vértices
@@ -411,7 +368,7 @@ int setupSprite()
 	return VAO;
 }
 
-void drawSprite(GLuint shaderID, Sprite spr)
+void drawSprite(GLint modelLoc, Sprite spr)
 {
 	// Neste código, usamos o mesmo buffer de geomtria para todos os sprites
 	glBindVertexArray(spr.VAO);				 // Conectando ao buffer de geometria
@@ -423,7 +380,7 @@ void drawSprite(GLuint shaderID, Sprite spr)
 	model = translate(model, spr.pos);
 	model = rotate(model, radians(spr.angle),vec3(0.0,0.0,1.0));
 	model = scale(model, spr.dimensions);
-	glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, value_ptr(model));
+	glUniformMatrix4fv(modelLoc, 1, GL_FALSE, value_ptr(model));
 	// Chamada de desenho - drawcall
 	// Poligono Preenchido - GL_TRIANGLES
 	glDrawArrays(GL_TRIANGLES, 0, 6);